@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Coordinate.h"
+#include "Geometry.h"
+#include "Model.h"
+#include "Spaceship.h"
+
+/**
+ * Times the movement of real rockets and reports their size under the configured coordinate storage.
+ * The storage is fixed at compile time, so compare double, float and fixed point by building this benchmark
+ * together with the rest of the tree once plain, once with COORDINATE_FLOAT and once with COORDINATE_FIXED.
+ * Fixed point stores int64 coordinates, as wide as double, so a rocket keeps its size and only float shrinks it.
+ * Usage: CoordinateBenchmark [objects] [ticks]
+ */
+
+namespace {
+    double coordinate(uint64_t &seed) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (double)(seed >> 40) / (1 << 24) * 100000 * Model::scale;
+    }
+
+    std::vector<Destroyer::Rocket> makeRockets(size_t count) {
+        uint64_t seed = 42;
+        std::vector<Destroyer::Rocket> rockets;
+        rockets.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            double x = coordinate(seed);
+            double y = coordinate(seed);
+            Object::Point start(x, y);
+            x = coordinate(seed);
+            y = coordinate(seed);
+            rockets.emplace_back(start, Object::Point(x, y));
+        }
+        return rockets;
+    }
+
+    void report(const char *mode, size_t count, size_t ticks, std::chrono::steady_clock::duration duration) {
+        double seconds = std::chrono::duration<double>(duration).count();
+        std::cout << Coordinate::name << " " << mode
+                  << ": " << sizeof(Destroyer::Rocket) << " bytes per rocket, "
+                  << (double)(count * sizeof(Destroyer::Rocket)) / (1 << 20) << " MiB, "
+                  << (double)(count * ticks) / seconds / 1e6 << " M moves/s" << std::endl;
+    }
+
+    /**
+     * Move every rocket on its own, as MovingObject::update does for a single object.
+     */
+    void objectBenchmark(size_t count, size_t ticks) {
+        std::vector<Destroyer::Rocket> rockets = makeRockets(count);
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t tick = 0; tick < ticks; ++tick) {
+            for (auto &rocket: rockets) {
+                rocket.MovingObject::update();
+            }
+        }
+        report("object", count, ticks, std::chrono::steady_clock::now() - begin);
+    }
+
+    /**
+     * Move the rockets in one batch, as the model does: decode, advance all of them, then place each one.
+     */
+    void batchBenchmark(size_t count, size_t ticks) {
+        std::vector<Destroyer::Rocket> rockets = makeRockets(count);
+        std::vector<double> xs(count), ys(count), toXs(count), toYs(count), speeds(count);
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t tick = 0; tick < ticks; ++tick) {
+            for (size_t i = 0; i < count; ++i) {
+                Object::Point location = rockets[i].getLocation();
+                Object::Point destination = rockets[i].getDestination();
+                xs[i] = location[0];
+                ys[i] = location[1];
+                toXs[i] = destination[0];
+                toYs[i] = destination[1];
+                speeds[i] = rockets[i].getSpeed();
+            }
+            Geometry::advance(xs.data(), ys.data(), toXs.data(), toYs.data(), speeds.data(), count);
+            for (size_t i = 0; i < count; ++i) {
+                rockets[i].advanceTo({xs[i], ys[i]});
+            }
+        }
+        report("batch", count, ticks, std::chrono::steady_clock::now() - begin);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? std::stoull(argv[1]) : 1000000;
+    size_t ticks = argc > 2 ? std::stoull(argv[2]) : 20;
+    std::cout << "Kernels: " << Geometry::name(Geometry::isa()) << ", storage: " << Coordinate::name << std::endl;
+    objectBenchmark(count, ticks);
+    batchBenchmark(count, ticks);
+    return 0;
+}
@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Geometry.h"
+#include "Model.h"
+#include "Profiler.h"
+#include "Utilities.h"
+#include "View.h"
+
+/**
+ * Times the hot paths of the simulation core and prints the results as JSON, so builds can be compared.
+ * Micro benchmarks time one operation in a loop. Lookups, bomber routing, the view and whole ticks are timed
+ * on one world that grows through 1k, 100k and 1M entities, sites and spaceships counted together.
+ * Every result is the median and the best of a few samples taken after a warm-up run.
+ * Usage: CoreBenchmark [maximal entities]
+ */
+
+namespace {
+    struct Result {
+        std::string name;
+        size_t entities;
+        size_t operations;
+        double median;
+        double best;
+    };
+
+    std::vector<Result> results;
+
+    /**
+     * Keep the compiler from dropping a computation whose result is never used.
+     * @tparam Type The type of the result.
+     * @param value The result.
+     */
+    template<class Type>
+    void keep(const Type &value) {
+#if defined(__GNUC__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static const volatile void *sink;
+        sink = &value;
+#endif
+    }
+
+    uint64_t next(uint64_t &seed) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return seed >> 33;
+    }
+
+    double coordinate(uint64_t &seed) {
+        return (double)(next(seed) % 1000000) / 1000 * Model::scale;
+    }
+
+    /**
+     * Time a batch of operations.
+     * @tparam Body A callable running the batch.
+     * @param name The benchmark name.
+     * @param entities The number of entities in the world, 0 for micro benchmarks.
+     * @param operations The number of operations in one batch.
+     * @param samples The number of timed batches.
+     * @param body The batch.
+     */
+    template<class Body>
+    void measure(const std::string &name, size_t entities, size_t operations, size_t samples, Body body) {
+        body();
+        std::vector<double> times;
+        for (size_t sample = 0; sample < samples; ++sample) {
+            auto begin = std::chrono::steady_clock::now();
+            body();
+            times.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / (double)operations);
+        }
+        std::sort(times.begin(), times.end());
+        results.push_back({name, entities, operations, times[times.size() / 2], times.front()});
+        std::cerr << name << " (" << entities << "): " << times[times.size() / 2] << " ns" << std::endl;
+    }
+
+    void vectorBenchmarks() {
+        using Point = Object::Point;
+        const size_t count = 1 << 16;
+        uint64_t seed = 1;
+        std::vector<Point> points;
+        for (size_t i = 0; i < count; ++i) {
+            points.emplace_back(coordinate(seed), coordinate(seed));
+        }
+        measure("vector_add", 0, count, 9, [&points]() -> void {
+            Point sum(0.0, 0.0);
+            for (const Point &point: points) {
+                sum += point;
+            }
+            keep(sum);
+        });
+        measure("vector_sub_norm", 0, count - 1, 9, [&points]() -> void {
+            double total = 0;
+            for (size_t i = 1; i < points.size(); ++i) {
+                total += (points[i] - points[i - 1]).norm();
+            }
+            keep(total);
+        });
+        measure("vector_scale_dot", 0, count, 9, [&points]() -> void {
+            double total = 0;
+            for (const Point &point: points) {
+                total += (point * 0.5).dot(point);
+            }
+            keep(total);
+        });
+        measure("vector_normalize", 0, count, 9, [&points]() -> void {
+            double total = 0;
+            for (const Point &point: points) {
+                Point direction = point + 1.0;
+                total += direction.normalize()[0];
+            }
+            keep(total);
+        });
+    }
+
+    void movingObjectBenchmark() {
+        const size_t count = 1 << 16;
+        uint64_t seed = 2;
+        std::vector<Destroyer::Rocket> rockets;
+        rockets.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            rockets.emplace_back(Object::Point(coordinate(seed), coordinate(seed)), Object::Point(1e12, 1e12));
+        }
+        measure("moving_object_update", 0, count, 9, [&rockets]() -> void {
+            for (Destroyer::Rocket &rocket: rockets) {
+                rocket.MovingObject::update();
+            }
+            keep(rockets.front());
+        });
+    }
+
+    void splitBenchmark() {
+        const size_t count = 1 << 14;
+        const std::vector<std::string> lines = {
+            "create bomber B12 C12 S483",
+            "shuttle1   transport  Station7 Star2",
+            "F9 course 45.5 2000",
+            "status",
+        };
+        measure("utilities_split", 0, count, 9, [&lines]() -> void {
+            size_t words = 0;
+            for (size_t i = 0; i < count; ++i) {
+                words += Utilities::split(lines[i % lines.size()]).size();
+            }
+            keep(words);
+        });
+    }
+
+    /**
+     * Grows the world through the model, one entity kind after another in a fixed pattern.
+     */
+    class World {
+    public:
+        World() : model(), seed(3), created(0) {
+
+        }
+        size_t size() const {
+            return model.getSites().size() + model.getSpaceships().size();
+        }
+        void grow(size_t entities) {
+            while (size() < entities) {
+                std::string id = std::to_string(created);
+                double x = coordinate(seed);
+                double y = coordinate(seed);
+                switch (created % 8) {
+                    case 0:
+                    case 1:
+                    case 2:
+                    case 3:
+                        model.createSpaceStation(Symbol::intern("S" + id), x, y, 1000, 1 + created % 5);
+                        stations.push_back(Symbol::intern("S" + id));
+                        break;
+                    case 4:
+                    case 5:
+                        model.createFalcon(Symbol::intern("F" + id), x, y);
+                        model.course(Symbol::intern("F" + id), (double)(next(seed) % 360), 2000);
+                        spaceships.push_back(Symbol::intern("F" + id));
+                        break;
+                    case 6:
+                        model.createShipman(Symbol::intern("m" + id));
+                        model.createShuttle(Symbol::intern("H" + id), Symbol::intern("m" + id), x, y);
+                        model.transport(Symbol::intern("H" + id), stations[next(seed) % stations.size()], Symbol::intern("DS"));
+                        spaceships.push_back(Symbol::intern("H" + id));
+                        agents.push_back(Symbol::intern("m" + id));
+                        break;
+                    default:
+                        model.createAdmiral(Symbol::intern("a" + id));
+                        model.createDestroyer(Symbol::intern("D" + id), Symbol::intern("a" + id), x, y);
+                        model.course(Symbol::intern("D" + id), (double)(next(seed) % 360));
+                        spaceships.push_back(Symbol::intern("D" + id));
+                        break;
+                }
+                ++created;
+            }
+        }
+        /**
+         * Add bombers patrolling from the fortress star. Their tours are computed over the sites there are now.
+         * @param count The number of bombers.
+         */
+        void addBombers(size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                std::string id = std::to_string(i);
+                model.createCommander(Symbol::intern("c" + id));
+                model.createBomber(Symbol::intern("B" + id), Symbol::intern("c" + id), Symbol::intern("DS"));
+                spaceships.push_back(Symbol::intern("B" + id));
+            }
+        }
+        Model model;
+        uint64_t seed;
+        size_t created;
+        std::vector<Symbol> stations;
+        std::vector<Symbol> spaceships;
+        std::vector<Symbol> agents;
+    };
+
+    void worldBenchmarks(World &world) {
+        const size_t entities = world.size();
+        const size_t lookups = 1 << 16;
+        Model &model = world.model;
+        uint64_t seed = 4;
+        std::vector<size_t> picks;
+        for (size_t i = 0; i < lookups; ++i) {
+            picks.push_back(next(seed));
+        }
+        measure("model_find_spaceship", entities, lookups, 9, [&]() -> void {
+            for (size_t pick: picks) {
+                keep(model.findSpaceship(world.spaceships[pick % world.spaceships.size()]));
+            }
+        });
+        measure("model_find_site", entities, lookups, 9, [&]() -> void {
+            for (size_t pick: picks) {
+                keep(model.findSite(world.stations[pick % world.stations.size()]));
+            }
+        });
+        measure("model_find_agent", entities, lookups, 9, [&]() -> void {
+            for (size_t pick: picks) {
+                keep(model.findAgent(world.agents[pick % world.agents.size()]));
+            }
+        });
+        // Bomber::next is private. Off its cached tour it is one nearest-unvisited query, which is timed here.
+        const SiteIndex &index = model.getSiteIndex();
+        SiteIndex::Visited visited(index, index.size());
+        for (size_t i = 0; i < index.size(); i += 2) {
+            visited.insert(i);
+        }
+        const size_t queries = 1 << 12;
+        measure("bomber_next", entities, queries, 5, [&]() -> void {
+            for (size_t i = 0; i < queries; ++i) {
+                keep(index.nearest(index.get(picks[i] % index.size())->getLocation(), visited));
+            }
+        });
+        std::ostringstream discard;
+        View view(model);
+        measure("view_show", entities, 1, 3, [&]() -> void {
+            view.show(discard);
+            discard.str("");
+        });
+        measure("model_update", entities, 1, 5, [&model]() -> void {
+            model.update();
+        });
+    }
+
+    void print(std::ostream &stream) {
+        stream << "{\n  \"geometry\": \"" << Geometry::name(Geometry::isa()) << "\",\n"
+               << "  \"coordinates\": \"" << Coordinate::name << "\",\n"
+               << "  \"profiler\": " << (Profiler::enabled ? "true" : "false") << ",\n"
+               << "  \"results\": [";
+        const char *separator = "\n";
+        for (const Result &result: results) {
+            stream << separator << "    {\"name\": \"" << result.name << "\", \"entities\": " << result.entities
+                   << ", \"operations\": " << result.operations << ", \"median_ns\": " << result.median
+                   << ", \"best_ns\": " << result.best << "}";
+            separator = ",\n";
+        }
+        stream << "\n  ]\n}" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t maximum = argc > 1 ? std::stoull(argv[1]) : 1000000;
+    vectorBenchmarks();
+    movingObjectBenchmark();
+    splitBenchmark();
+    World world;
+    bool bombers = false;
+    for (size_t entities: {(size_t)1000, (size_t)100000, (size_t)1000000}) {
+        if (entities > maximum) break;
+        world.grow(entities);
+        if (!bombers) {
+            world.addBombers(8);
+            bombers = true;
+        }
+        worldBenchmarks(world);
+    }
+    print(std::cout);
+    return 0;
+}
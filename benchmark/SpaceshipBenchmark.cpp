@@ -0,0 +1,94 @@
+#include <malloc.h>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include "Model.h"
+
+/**
+ * Measures the memory footprint of every spaceship type when created through the Model.
+ * A ship's footprint is the heap the Model grows by while creating it: the object itself,
+ * its control block, its registry slot, its set node and everything it allocates on its own.
+ * Agents are created before the measurement, so they are not counted.
+ * Setting a course should cost no heap at all. Ticks are timed after a first one touched every ship.
+ * Usage: SpaceshipBenchmark [ships per type]
+ */
+
+namespace {
+    size_t heap = 0;
+
+    struct Footprint {
+        size_t heap;
+        double seconds;
+    };
+
+    Footprint measure(size_t count, const std::function<void(size_t)> &create) {
+        size_t before = heap;
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            create(i);
+        }
+        return {heap - before, std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count()};
+    }
+
+    void report(const char *type, size_t size, size_t count, const Footprint &footprint) {
+        std::cout << type << ": " << size << " bytes inline, "
+                  << (double)footprint.heap / (double)count << " bytes per ship, "
+                  << (double)footprint.heap / (1 << 20) << " MiB for " << count << " ships in "
+                  << footprint.seconds << " s" << std::endl;
+    }
+}
+
+void *operator new(size_t size) {
+    void *pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr) throw std::bad_alloc();
+    heap += malloc_usable_size(pointer);
+    return pointer;
+}
+
+void operator delete(void *pointer) noexcept {
+    if (pointer == nullptr) return;
+    heap -= malloc_usable_size(pointer);
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    operator delete(pointer);
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? std::stoull(argv[1]) : 1000000;
+    Model model;
+    for (size_t i = 0; i < count; ++i) {
+        model.createShipman(Symbol::intern("m" + std::to_string(i)));
+        model.createCommander(Symbol::intern("c" + std::to_string(i)));
+        model.createAdmiral(Symbol::intern("a" + std::to_string(i)));
+    }
+    std::cout << "Coordinate storage: " << Coordinate::name << std::endl;
+    report("Shuttle", sizeof(Shuttle), count, measure(count, [&model](size_t i) -> void {
+        model.createShuttle(Symbol::intern("s" + std::to_string(i)), Symbol::intern("m" + std::to_string(i)), (double)i, (double)i);
+    }));
+    report("Bomber", sizeof(Bomber), count, measure(count, [&model](size_t i) -> void {
+        model.createBomber(Symbol::intern("b" + std::to_string(i)), Symbol::intern("c" + std::to_string(i)), Symbol::intern("DS"));
+    }));
+    report("Destroyer", sizeof(Destroyer), count, measure(count, [&model](size_t i) -> void {
+        model.createDestroyer(Symbol::intern("d" + std::to_string(i)), Symbol::intern("a" + std::to_string(i)), (double)i, (double)i);
+    }));
+    report("Falcon", sizeof(Falcon), count, measure(count, [&model](size_t i) -> void {
+        model.createFalcon(Symbol::intern("f" + std::to_string(i)), (double)i, (double)i);
+    }));
+    report("Falcon course", 0, count, measure(count, [&model](size_t i) -> void {
+        model.course(Symbol::intern("f" + std::to_string(i)), (double)(i % 360), 2000);
+    }));
+    model.update();
+    size_t ticks = 10;
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t tick = 0; tick < ticks; ++tick) {
+        model.update();
+    }
+    std::cout << "One tick over " << 4 * count << " ships: "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() / (double)ticks << " s" << std::endl;
+    return 0;
+}
@@ -3,63 +3,71 @@
 
 #include <string>
 #include <memory>
+#include "Handle.h"
+#include "Symbol.h"
 
 class Agent {
 public:
     const std::string &getName() const;
+    Symbol getSymbol() const;
+    Handle<Agent> getHandle() const;
+    void setHandle(const Handle<Agent> &h);
 protected:
-    explicit Agent(std::string name);
+    explicit Agent(Symbol name);
     virtual ~Agent();
     virtual void print(std::ostream &stream) const;
     virtual void printType(std::ostream &stream) const = 0;
     friend std::ostream &operator<<(std::ostream &stream, const Agent &agent);
 private:
-    std::string name;
+    Symbol name;
+    Handle<Agent> handle;
 };
 
+class AgentRegistry;
+
 class Shipman : public Agent {
 public:
     ~Shipman() override;
-    explicit Shipman(const std::string &name);
+    explicit Shipman(Symbol name);
     void printType(std::ostream &stream) const override;
 };
 
 class Commander : public Agent {
 public:
     ~Commander() override;
-    explicit Commander(const std::string &name);
+    explicit Commander(Symbol name);
     void printType(std::ostream &stream) const override;
 };
 
 class Admiral : public Agent {
 public:
     ~Admiral() override;
-    explicit Admiral(const std::string &name);
+    explicit Admiral(Symbol name);
     void printType(std::ostream &stream) const override;
 };
 
 class AgentFactory {
 public:
     virtual ~AgentFactory();
-    virtual std::shared_ptr<Agent> create(const std::string &name) const = 0;
+    virtual Handle<Agent> create(Symbol name, AgentRegistry &registry) const = 0;
 };
 
 class ShipmanFactory : public AgentFactory {
 public:
     ~ShipmanFactory() override;
-    std::shared_ptr<Agent> create(const std::string &name) const override;
+    Handle<Agent> create(Symbol name, AgentRegistry &registry) const override;
 };
 
 class CommanderFactory : public AgentFactory {
 public:
     ~CommanderFactory() override;
-    std::shared_ptr<Agent> create(const std::string &name) const override;
+    Handle<Agent> create(Symbol name, AgentRegistry &registry) const override;
 };
 
 class AdmiralFactory : public AgentFactory {
 public:
     ~AdmiralFactory() override;
-    std::shared_ptr<Agent> create(const std::string &name) const override;
+    Handle<Agent> create(Symbol name, AgentRegistry &registry) const override;
 };
 
 #endif //HW03_AGENT_H
@@ -0,0 +1,97 @@
+#ifndef HW03_AGENTREGISTRY_H
+#define HW03_AGENTREGISTRY_H
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include "Agent.h"
+#include "Handle.h"
+#include "Symbol.h"
+
+/**
+ * Owns every agent, assigned or not. Agents of each rank live back to back in their own slab,
+ * so creating one allocates nothing on its own and its address never changes.
+ * Whether an agent drives a spaceship is one bit per agent.
+ * Create, find, take and release are O(1).
+ */
+class AgentRegistry {
+public:
+    AgentRegistry();
+    /**
+     * Create an agent.
+     * @tparam Type Shipman, Commander or Admiral.
+     * @param name The name of the agent. It must not be taken.
+     * @return A handle to the agent.
+     */
+    template<class Type>
+    Handle<Agent> create(Symbol name) {
+        std::deque<Type> &agents = slab<Type>();
+        agents.emplace_back(name);
+        Agent &agent = agents.back();
+        agent.setHandle(slots.insert(std::shared_ptr<Agent>(std::shared_ptr<Agent>(), &agent)));
+        names.emplace(name, agent.getHandle());
+        if (assigned.size() * 64 <= agent.getHandle().getIndex()) assigned.push_back(0);
+        dirty = true;
+        return agent.getHandle();
+    }
+    /**
+     * Find an agent by name.
+     * @param name The name of the agent.
+     * @return The agent, nullptr if there is none.
+     */
+    Agent *find(Symbol name) const;
+    Agent *resolve(const Handle<Agent> &handle) const;
+    bool isAssigned(const Handle<Agent> &handle) const;
+    /**
+     * Assign an agent to a spaceship.
+     * @param handle The agent.
+     * @throw std::out_of_range if the agent is already assigned.
+     */
+    void take(const Handle<Agent> &handle);
+    /**
+     * Make an agent available again.
+     * @param handle The agent.
+     */
+    void release(const Handle<Agent> &handle);
+    /**
+     * Get the agents that drive no spaceship.
+     * @return The unassigned agents, ordered by name.
+     */
+    std::vector<const Agent *> unassigned() const;
+    size_t size() const;
+private:
+    template<class Type>
+    std::deque<Type> &slab();
+    std::deque<Shipman> shipmen;
+    std::deque<Commander> commanders;
+    std::deque<Admiral> admirals;
+    /**
+     * Non-owning slots, so handles to agents resolve and go stale like any other handle.
+     */
+    Registry<Agent> slots;
+    std::unordered_map<Symbol, Handle<Agent>> names;
+    std::vector<uint64_t> assigned;
+    /**
+     * Every agent ordered by name, sorted again only after agents were created.
+     */
+    mutable std::vector<const Agent *> order;
+    mutable bool dirty;
+};
+
+template<>
+inline std::deque<Shipman> &AgentRegistry::slab<Shipman>() {
+    return shipmen;
+}
+
+template<>
+inline std::deque<Commander> &AgentRegistry::slab<Commander>() {
+    return commanders;
+}
+
+template<>
+inline std::deque<Admiral> &AgentRegistry::slab<Admiral>() {
+    return admirals;
+}
+
+#endif //HW03_AGENTREGISTRY_H
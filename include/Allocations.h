@@ -0,0 +1,79 @@
+#ifndef HW03_ALLOCATIONS_H
+#define HW03_ALLOCATIONS_H
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+
+/**
+ * Counts the heap allocations made through operator new and charges them to the subsystem in scope on the thread.
+ * Every scope of a subsystem is one command or one tick, so the report shows the churn per command and per tick.
+ * Counting is off until turned on, and costs one load and one branch per allocation while off.
+ * Compiling with DISABLE_ALLOCATIONS keeps the standard operator new.
+ */
+class Allocations {
+public:
+#ifdef DISABLE_ALLOCATIONS
+    static constexpr bool compiled = false;
+#else
+    static constexpr bool compiled = true;
+#endif
+    enum Subsystem {OTHER, CONTROLLER, TICK, VIEW, CREATION, SUBSYSTEMS};
+    static constexpr const char *names[SUBSYSTEMS] = {"Other", "Controller", "Model tick", "View", "Creation"};
+    /**
+     * Charges the allocations made from its construction to its destruction to a subsystem,
+     * except for those made in a nested scope.
+     */
+    class Scope {
+    public:
+        explicit Scope(Subsystem subsystem) : previous(current), subsystem(subsystem), allocations(0), bytes(0) {
+            current = this;
+        }
+        ~Scope() {
+            current = previous;
+            close(subsystem, allocations, bytes);
+        }
+        Scope(const Scope &scope) = delete;
+        Scope &operator=(const Scope &scope) = delete;
+    private:
+        friend class Allocations;
+        Scope *previous;
+        Subsystem subsystem;
+        size_t allocations;
+        size_t bytes;
+    };
+    static bool isEnabled() {
+        if constexpr (compiled) return enabled.load(std::memory_order_relaxed);
+        return false;
+    }
+    static void setEnabled(bool on);
+    /**
+     * Forget everything counted so far.
+     */
+    static void reset();
+    /**
+     * Charge an allocation to the subsystem in scope. Called by operator new.
+     * @param size The bytes requested.
+     */
+    static void count(size_t size) {
+        if (!isEnabled()) return;
+        if (current == nullptr) {
+            record(OTHER, size);
+        } else {
+            ++current->allocations;
+            current->bytes += size;
+        }
+    }
+    /**
+     * Print the allocations and bytes of every subsystem, in total, per scope on average and in the worst scope.
+     * @param stream The stream to print to.
+     */
+    static void print(std::ostream &stream);
+private:
+    static void record(Subsystem subsystem, size_t size);
+    static void close(Subsystem subsystem, size_t allocations, size_t bytes);
+    static inline std::atomic<bool> enabled{false};
+    static inline thread_local Scope *current = nullptr;
+};
+
+#endif //HW03_ALLOCATIONS_H
@@ -0,0 +1,67 @@
+#ifndef HW03_ARCHIVE_H
+#define HW03_ARCHIVE_H
+
+#include <array>
+#include <map>
+#include <vector>
+#include "PointGrid.h"
+#include "Spaceship.h"
+
+/**
+ * The wrecks of the dead spaceships of a world, by name, by kind and by place.
+ * Wrecks never leave or move, so the map nodes holding them give stable pointers to the kind lists and the grid.
+ * Only the crystals of a wreck change, when a falcon plunders it.
+ */
+class Archive {
+private:
+    class NameComparator {
+    public:
+        bool operator()(Symbol a, Symbol b) const {
+            return a.str() < b.str();
+        }
+    };
+public:
+    using Wrecks = std::map<Symbol, Wreck, NameComparator>;
+    /**
+     * Constructs an empty archive.
+     * @param cell The side of a cell of the grid of the wrecks.
+     */
+    explicit Archive(double cell);
+    Archive(const Archive &archive) = delete;
+    Archive &operator=(const Archive &archive) = delete;
+    /**
+     * Keep the wreck of a dead spaceship.
+     * @param spaceship The spaceship, which is about to leave its world.
+     */
+    void add(const Spaceship &spaceship);
+    /**
+     * Find the wreck of a spaceship.
+     * @param name The name of the spaceship.
+     * @return The wreck, nullptr if there is none.
+     */
+    const Wreck *find(Symbol name) const;
+    Wreck *find(Symbol name);
+    size_t size() const;
+    Wrecks::const_iterator begin() const;
+    Wrecks::const_iterator end() const;
+    /**
+     * Get the wrecks of a kind of spaceship.
+     * @param kind The kind.
+     * @return The wrecks, in the order they were archived.
+     */
+    const std::vector<const Wreck *> &ofKind(Spaceship::Kind kind) const;
+    /**
+     * Find the wrecks within a radius of a center.
+     * @param center The center.
+     * @param radius The radius.
+     * @param found Receives the wrecks, in no particular order.
+     */
+    void within(const Object::Point &center, double radius, std::vector<const Wreck *> &found) const;
+private:
+    Wrecks wrecks;
+    std::array<std::vector<const Wreck *>, 4> kinds;
+    std::vector<const Wreck *> ids;
+    PointGrid grid;
+};
+
+#endif //HW03_ARCHIVE_H
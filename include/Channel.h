@@ -0,0 +1,45 @@
+#ifndef HW03_CHANNEL_H
+#define HW03_CHANNEL_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * One end of a local stream socket between two processes. A message is a list of fields, sent as the number of fields
+ * followed by every field prefixed with its length, so fields may hold any bytes, newlines included.
+ */
+class Channel {
+public:
+    /**
+     * Create two connected ends.
+     * @return The ends.
+     * @throw std::runtime_error if the socket cannot be created.
+     */
+    static std::pair<Channel, Channel> pair();
+    explicit Channel(int descriptor = -1);
+    ~Channel();
+    Channel(const Channel &channel) = delete;
+    Channel &operator=(const Channel &channel) = delete;
+    Channel(Channel &&channel) noexcept;
+    Channel &operator=(Channel &&channel) noexcept;
+    /**
+     * Send a message, blocking until all of it is written.
+     * @param fields The fields of the message.
+     * @throw std::runtime_error if the other end is closed.
+     */
+    void send(const std::vector<std::string> &fields);
+    /**
+     * Receive a message, blocking until all of it is read.
+     * @return The fields of the message.
+     * @throw std::runtime_error if the other end is closed.
+     */
+    std::vector<std::string> receive();
+    void close();
+private:
+    void write(const char *data, size_t size);
+    void read(char *data, size_t size);
+    int descriptor;
+};
+
+#endif //HW03_CHANNEL_H
@@ -2,27 +2,83 @@
 #define HW03_CONTROLLER_H
 
 #include <functional>
+#include <iostream>
 #include <map>
+#include <memory>
+#include "Model.h"
+#include "Shards.h"
 #include "Spaceship.h"
 #include "Vector.h"
 #include "View.h"
 
 class Controller {
 public:
-    Controller();
+    /**
+     * Constructs a controller of a world of its own.
+     * @param inputStream The stream commands are read from.
+     * @param outputStream The stream results are written to.
+     * @param errorStream The stream errors are written to.
+     */
+    explicit Controller(std::istream &inputStream = std::cin, std::ostream &outputStream = std::cout, std::ostream &errorStream = std::cerr);
+    ~Controller();
     void run(int argc, char *argv[]);
+    /**
+     * Load the sites file and run the commands until exit or the end of the input.
+     * @param path The sites file.
+     * @param shards The number of processes to split the world across, 1 to keep it in this one.
+     * @return false if the sites file could not be loaded, true otherwise.
+     */
+    bool run(const std::string &path, size_t shards = 1);
+    /**
+     * Load the sites file.
+     * @param path The sites file.
+     * @param shards The number of processes to split the world across, 1 to keep it in this one.
+     * @throw std::invalid_argument if the file cannot be opened or parsed.
+     * @throw std::runtime_error if a shard cannot be started.
+     */
+    void open(const std::string &path, size_t shards = 1);
+    /**
+     * Run one command, writing its results and errors to the streams of the controller.
+     * @param line The command.
+     * @return false if the command was exit, true otherwise.
+     */
+    bool execute(std::string line);
+    Model &getModel();
+    size_t getTime() const;
 private:
     using Commands = std::map<std::string, std::function<void(const std::vector<std::string>&)>>;
-    static void open(const std::string &path);
     static double parseXY(const std::string &arg);
     static double parseSpeed(const std::string &arg);
     static void sanitize(std::string &line);
+    /**
+     * Get the symbol of a name that looks an entity up, without interning it.
+     * @param name The name.
+     * @param kind The kind of the entity with its article, as the lookups in Model name it.
+     * @return The symbol.
+     * @throw std::out_of_range if no entity was ever named so.
+     */
+    static Symbol find(const std::string &name, const std::string &kind);
+    /**
+     * Write the trace events recorded so far as a Chrome trace.
+     * @param path The file to write.
+     * @throw std::invalid_argument if the file cannot be opened.
+     */
+    void dumpTrace(const std::string &path);
     void run();
+    std::istream &input;
+    std::ostream &output;
+    std::ostream &errors;
+    Model model;
+    /**
+     * The shards the world is split across, nullptr while it lives in this process.
+     */
+    std::unique_ptr<Shards> shards;
     Commands modelViewCommands;
     Commands spaceshipCommands;
     Commands creatorCommand;
     View view;
     size_t time;
+    std::string traceFile;
 };
 
 #endif //HW03_CONTROLLER_H
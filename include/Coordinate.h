@@ -0,0 +1,73 @@
+#ifndef HW03_COORDINATE_H
+#define HW03_COORDINATE_H
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include "Vector.h"
+
+/**
+ * Describes how coordinates are stored: double, float, or an integer fixed point in Model::scale units.
+ * Computation always happens in double and positions are encoded into Type when they are stored.
+ * Two positions are equal only if their stored values are equal.
+ * A step that ends less than epsilon away from its destination snaps onto it.
+ * @tparam Type The type coordinates are stored in.
+ */
+template<class Type>
+class CoordinateStorage {
+public:
+    using Stored = Vector<Type, 2>;
+    static constexpr bool fixed = std::is_integral<Type>::value;
+    /**
+     * double keeps the historical 1e-10. float keeps a thousandth of a unit up to 8 km from the origin.
+     * Distinct fixed points are at least one unit apart, so fixed snaps only what rounding did not already land.
+     */
+    static constexpr double epsilon = fixed ? 1 : std::is_same<Type, float>::value ? 1e-3 : 1e-10;
+    static constexpr const char *name = fixed ? "fixed" : std::is_same<Type, float>::value ? "float" : "double";
+    /**
+     * Encode a coordinate into its stored form.
+     * @param value The coordinate.
+     * @return The stored coordinate, rounded to the nearest unit for fixed point.
+     */
+    static Type encode(double value) {
+        if constexpr (fixed) {
+            return (Type)std::llround(value);
+        } else {
+            return (Type)value;
+        }
+    }
+    /**
+     * Decode a stored coordinate.
+     * @param value The stored coordinate.
+     * @return The coordinate in double precision.
+     */
+    static double decode(Type value) {
+        return (double)value;
+    }
+    /**
+     * Encode a point into its stored form.
+     * @param point The point to encode.
+     * @return The stored point.
+     */
+    static Stored encode(const Vector<double, 2> &point) {
+        return {encode(point[0]), encode(point[1])};
+    }
+    /**
+     * Decode a stored point.
+     * @param point The stored point.
+     * @return The point in double precision.
+     */
+    static Vector<double, 2> decode(const Stored &point) {
+        return {decode(point[0]), decode(point[1])};
+    }
+};
+
+#if defined(COORDINATE_FIXED)
+using Coordinate = CoordinateStorage<int64_t>;
+#elif defined(COORDINATE_FLOAT)
+using Coordinate = CoordinateStorage<float>;
+#else
+using Coordinate = CoordinateStorage<double>;
+#endif
+
+#endif //HW03_COORDINATE_H
@@ -0,0 +1,61 @@
+#ifndef HW03_DISPATCHER_H
+#define HW03_DISPATCHER_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Handle.h"
+#include "SiteIndex.h"
+
+class Model;
+class Shuttle;
+class Spaceship;
+
+/**
+ * Assigns (station, star) supply jobs to idle shuttles across the whole fleet.
+ * Every tick it plans at most budget shuttles and scores only the candidates closest stations of each,
+ * so planning stays bounded no matter how large the fleet or the map is.
+ * A job is scored by the crystals it is expected to deliver per tick of travel, using the station's stock at arrival,
+ * its production rate and the crystals already promised to other shuttles.
+ * A promise is dropped as soon as its shuttle loads at the station, when the crystals leave the stock, or drops the job.
+ */
+class Dispatcher {
+public:
+    Dispatcher();
+    void setEnabled(bool e);
+    bool isEnabled() const;
+    void dispatch(const Model &model);
+    /**
+     * Drop the crystals a shuttle was promised at the station of its job, if the dispatcher gave it one.
+     * @param shuttle The shuttle, which loaded at the station or dropped the job.
+     */
+    void release(const Handle<Spaceship> &shuttle);
+private:
+    struct Assignment {
+        Handle<Spaceship> shuttle;
+        size_t station;
+        size_t crystals;
+    };
+    static constexpr size_t budget = 256;
+    static constexpr size_t candidates = 8;
+    void refresh(const SiteIndex &index);
+    void assign(const SiteIndex &index, Shuttle &shuttle);
+    /**
+     * The open assignments by the slot of their shuttle.
+     */
+    std::unordered_map<uint32_t, Assignment> assignments;
+    std::vector<size_t> reserved;
+    std::vector<size_t> stars;
+    std::vector<double> starDistances;
+    SiteIndex::Visited others;
+    size_t sites;
+    /**
+     * Where the next tick starts looking for idle shuttles among the resting ones.
+     */
+    std::pair<uint64_t, uint32_t> cursor;
+    bool enabled;
+};
+
+#endif //HW03_DISPATCHER_H
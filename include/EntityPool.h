@@ -0,0 +1,74 @@
+#ifndef HW03_ENTITYPOOL_H
+#define HW03_ENTITYPOOL_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * A memory resource for the entities of one type. Every block has the size of the first request,
+ * which for std::allocate_shared is the entity together with its control block, so entities sit back to back
+ * in a few large chunks and a freed block is reused by the next entity without reaching the global allocator.
+ * Requests of another size or alignment go to the default resource.
+ */
+class EntityPool : public std::pmr::memory_resource {
+public:
+    EntityPool();
+    ~EntityPool() override = default;
+    EntityPool(const EntityPool &pool) = delete;
+    EntityPool &operator=(const EntityPool &pool) = delete;
+    /**
+     * Create an entity in the pool.
+     * @tparam Type The type of the entity.
+     * @tparam Args The types of the arguments of its constructor.
+     * @param args The arguments of its constructor.
+     * @return The entity. The pool has to outlive it.
+     */
+    template<class Type, class... Args>
+    std::shared_ptr<Type> create(Args &&...args) {
+        return std::allocate_shared<Type>(std::pmr::polymorphic_allocator<Type>(this), std::forward<Args>(args)...);
+    }
+    /**
+     * Make room for entities up front, so creating that many allocates at most one chunk in total.
+     * Before the first entity the room is taken once its block size is known.
+     * @param count The number of entities to make room for.
+     */
+    void reserve(size_t count);
+    /**
+     * Get the number of entities in the pool.
+     * @return The number of blocks in use.
+     */
+    size_t size() const;
+    /**
+     * Get the number of entities the pool holds without growing.
+     * @return The number of blocks in all chunks.
+     */
+    size_t capacity() const;
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+private:
+    static constexpr size_t firstChunk = 64;
+    /**
+     * Check if a request is served from the blocks.
+     * @param bytes The size of the request.
+     * @param alignment The alignment of the request.
+     * @return true if it rounds up to the block size, false otherwise.
+     */
+    bool pooled(size_t bytes, size_t alignment) const;
+    /**
+     * Add a chunk and thread its blocks onto the free list.
+     * @param blocks The number of blocks in the chunk.
+     */
+    void grow(size_t blocks);
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    void *free;
+    size_t block;
+    size_t used;
+    size_t total;
+    size_t reserved;
+};
+
+#endif //HW03_ENTITYPOOL_H
@@ -0,0 +1,92 @@
+#ifndef HW03_GEOMETRY_H
+#define HW03_GEOMETRY_H
+
+#include <cstddef>
+
+/**
+ * Batched kernels for the hot 2-D geometry: distance, move-toward and nearest-of-N.
+ * Points are passed as separate x and y arrays.
+ * The SSE2, AVX2 and AVX-512 implementations are picked at runtime and give bit-identical results to the scalar one.
+ */
+namespace Geometry {
+    /**
+     * The instruction sets a kernel can be implemented with.
+     */
+    enum Isa {SCALAR, SSE2, AVX2, AVX512};
+    /**
+     * An object this close to its destination after a step snaps onto it.
+     */
+    static constexpr double epsilon = 1e-10;
+    /**
+     * Calculate the distance from a point to many points.
+     * @param xs The x coordinates of the points.
+     * @param ys The y coordinates of the points.
+     * @param count The number of points.
+     * @param x The x coordinate of the point to measure from.
+     * @param y The y coordinate of the point to measure from.
+     * @param distances Receives count distances.
+     */
+    void distances(const double *xs, const double *ys, size_t count, double x, double y, double *distances);
+    /**
+     * Find the point closest to a point.
+     * @param xs The x coordinates of the points.
+     * @param ys The y coordinates of the points.
+     * @param count The number of points.
+     * @param x The x coordinate of the point to measure from.
+     * @param y The y coordinate of the point to measure from.
+     * @return The index of the closest point, the lowest one on ties. count if there is none.
+     */
+    size_t nearest(const double *xs, const double *ys, size_t count, double x, double y);
+    /**
+     * Advance many objects one tick toward their destinations.
+     * @param xs The x coordinates of the objects, updated in place.
+     * @param ys The y coordinates of the objects, updated in place.
+     * @param toXs The x coordinates of the destinations.
+     * @param toYs The y coordinates of the destinations.
+     * @param speeds The distance each object covers in a tick.
+     * @param count The number of objects.
+     */
+    void advance(double *xs, double *ys, const double *toXs, const double *toYs, const double *speeds, size_t count);
+    /**
+     * Advance a single object one tick toward its destination.
+     * @param x The x coordinate of the object, updated in place.
+     * @param y The y coordinate of the object, updated in place.
+     * @param toX The x coordinate of the destination.
+     * @param toY The y coordinate of the destination.
+     * @param speed The distance the object covers in a tick.
+     */
+    void advance(double &x, double &y, double toX, double toY, double speed);
+    /**
+     * Find when two points moving in straight lines over one tick first come within a radius of each other.
+     * @param ax The x coordinate of the first point at the start of the tick.
+     * @param ay The y coordinate of the first point at the start of the tick.
+     * @param aToX The x coordinate of the first point at the end of the tick.
+     * @param aToY The y coordinate of the first point at the end of the tick.
+     * @param bx The x coordinate of the second point at the start of the tick.
+     * @param by The y coordinate of the second point at the start of the tick.
+     * @param bToX The x coordinate of the second point at the end of the tick.
+     * @param bToY The y coordinate of the second point at the end of the tick.
+     * @param radius The contact distance.
+     * @return The fraction of the tick in [0, 1] at which they first touch, a value above 1 if they never do.
+     */
+    double contact(double ax, double ay, double aToX, double aToY, double bx, double by, double bToX, double bToY, double radius);
+    /**
+     * Get the instruction set the kernels currently run with.
+     * @return The selected instruction set.
+     */
+    Isa isa();
+    /**
+     * Select the instruction set the kernels run with.
+     * @param isa The requested instruction set. Falls back to the best supported one below it.
+     * @return The instruction set actually selected.
+     */
+    Isa setIsa(Isa isa);
+    /**
+     * Get the name of an instruction set.
+     * @param isa The instruction set.
+     * @return A printable name.
+     */
+    const char *name(Isa isa);
+}
+
+#endif //HW03_GEOMETRY_H
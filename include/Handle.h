@@ -0,0 +1,141 @@
+#ifndef HW03_HANDLE_H
+#define HW03_HANDLE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+template<class Type>
+class Registry;
+
+/**
+ * An 8-byte generational reference to an entity owned by a Registry.
+ * A handle whose slot was erased, or erased and reused, resolves to nullptr instead of to the wrong entity.
+ * @tparam Type The type of the referenced entity.
+ */
+template<class Type>
+class Handle {
+public:
+    /**
+     * Constructs a handle that refers to nothing.
+     */
+    Handle() : index(invalid), generation(0) {
+
+    }
+    bool operator==(const Handle<Type> &handle) const {
+        return index == handle.index && generation == handle.generation;
+    }
+    bool operator!=(const Handle<Type> &handle) const {
+        return !(*this == handle);
+    }
+    /**
+     * Checks if the handle was ever assigned. An assigned handle may still be stale.
+     * @return true if the handle refers to a slot, false otherwise.
+     */
+    explicit operator bool() const {
+        return index != invalid;
+    }
+    /**
+     * Get the slot the handle refers to. Slots are dense, so side tables can be indexed by it.
+     * @return The slot index.
+     */
+    uint32_t getIndex() const {
+        return index;
+    }
+private:
+    static constexpr uint32_t invalid = UINT32_MAX;
+    Handle(uint32_t index, uint32_t generation) : index(index), generation(generation) {
+
+    }
+    uint32_t index;
+    uint32_t generation;
+    friend class Registry<Type>;
+};
+
+/**
+ * Owns entities in slots and resolves handles to them in O(1) without touching reference counts.
+ * @tparam Type The type of the entities.
+ */
+template<class Type>
+class Registry {
+public:
+    /**
+     * Take ownership of an entity.
+     * @param value The entity.
+     * @return A handle to it.
+     */
+    Handle<Type> insert(std::shared_ptr<Type> value) {
+        uint32_t index;
+        if (free.empty()) {
+            index = (uint32_t)slots.size();
+            slots.push_back({nullptr, 0});
+        } else {
+            index = free.back();
+            free.pop_back();
+        }
+        slots[index].value = std::move(value);
+        ++count;
+        return {index, slots[index].generation};
+    }
+    /**
+     * Release an entity. Every handle to it becomes stale.
+     * @param handle The handle of the entity.
+     */
+    void erase(const Handle<Type> &handle) {
+        if (resolve(handle) == nullptr) return;
+        Slot &slot = slots[handle.index];
+        slot.value = nullptr;
+        ++slot.generation;
+        free.push_back(handle.index);
+        --count;
+    }
+    /**
+     * Resolve a handle.
+     * @param handle The handle to resolve.
+     * @return The entity, nullptr if the handle is unassigned or stale.
+     */
+    Type *resolve(const Handle<Type> &handle) const {
+        if (handle.index >= slots.size()) return nullptr;
+        const Slot &slot = slots[handle.index];
+        if (slot.generation != handle.generation) return nullptr;
+        return slot.value.get();
+    }
+    /**
+     * Get the entity in a slot.
+     * @param index The slot index, as given by Handle::getIndex.
+     * @return The entity, nullptr if the slot is free.
+     */
+    Type *at(uint32_t index) const {
+        return index < slots.size() ? slots[index].value.get() : nullptr;
+    }
+    /**
+     * Find an entity.
+     * @tparam Predicate A callable taking const Type & and returning bool.
+     * @param predicate The condition to look for.
+     * @return The first live entity matching predicate, nullptr if there is none.
+     */
+    template<class Predicate>
+    Type *find(Predicate predicate) const {
+        for (const Slot &slot: slots) {
+            if (slot.value != nullptr && predicate(*slot.value)) return slot.value.get();
+        }
+        return nullptr;
+    }
+    /**
+     * Get the number of live entities.
+     * @return The number of live entities.
+     */
+    size_t size() const {
+        return count;
+    }
+private:
+    struct Slot {
+        std::shared_ptr<Type> value;
+        uint32_t generation;
+    };
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free;
+    size_t count = 0;
+};
+
+#endif //HW03_HANDLE_H
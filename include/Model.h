@@ -1,70 +1,352 @@
 #ifndef HW03_MODEL_H
 #define HW03_MODEL_H
 
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 #include <set>
 #include <map>
+#include <unordered_map>
+#include "AgentRegistry.h"
+#include "Archive.h"
 #include "Spaceship.h"
+#include "Dispatcher.h"
+#include "EntityPool.h"
+#include "Handle.h"
+#include "PointGrid.h"
+#include "Profiler.h"
 #include "Site.h"
+#include "SiteIndex.h"
+#include "SweepGrid.h"
 
+/**
+ * A world: the sites, spaceships, agents and rockets of one simulation. Entities reach their world through a reference,
+ * and worlds share nothing mutable but the symbol table, so independent worlds can run on different threads.
+ */
 class Model {
 private:
+    /**
+     * Orders entities by name, as status prints them. Reading a name takes no lock, and the entity looked up
+     * is recognized by its symbol without comparing its name.
+     */
     class ObjectComparator {
     public:
-        bool operator()(const std::shared_ptr<Object> &a, const std::shared_ptr<Object> &b) {
-            return a->getName() < b->getName();
+        using is_transparent = void;
+        bool operator()(const std::shared_ptr<Object> &a, const std::shared_ptr<Object> &b) const {
+            return a != b && a->getName() < b->getName();
         }
-    };
-    class AgentComparator {
-    public:
-        bool operator()(const std::shared_ptr<Agent> &a, const std::shared_ptr<Agent> &b) {
-            return a->getName() < b->getName();
+        bool operator()(const std::shared_ptr<Object> &a, Symbol b) const {
+            return a->getSymbol() != b && a->getName() < b.str();
+        }
+        bool operator()(Symbol a, const std::shared_ptr<Object> &b) const {
+            return a != b->getSymbol() && a.str() < b->getName();
         }
     };
 public:
+    struct Economy {
+        size_t produced;
+        size_t delivered;
+        size_t stolen;
+    };
+    /**
+     * A falcon a rocket may hit, with the path it flew this tick.
+     */
+    struct Target {
+        Symbol name;
+        SweepGrid::Sweep path;
+    };
+    /**
+     * The entity types that are allocated from a pool of their own.
+     */
+    enum Pooled {SHUTTLES, BOMBERS, DESTROYERS, FALCONS, STATIONS, STARS, ROCKETS, POOLS};
     static constexpr double scale = 1000;
-    static Model &get();
+    /**
+     * The side of a cell of the grids of spaceships and wrecks, in the units of positions.
+     */
+    static constexpr double gridCell = scale;
+    /**
+     * Constructs a world holding only the fortress star DS.
+     */
+    Model();
     Model(const Model &model) = delete;
     Model &operator=(const Model &model) = delete;
     const std::set<std::shared_ptr<Spaceship>, ObjectComparator> &getSpaceships() const;
+    /**
+     * Get the spaceships of a kind.
+     * @param kind The kind.
+     * @return The spaceships of the kind, ordered by name.
+     */
+    const std::set<std::shared_ptr<Spaceship>, ObjectComparator> &getSpaceships(Spaceship::Kind kind) const;
+    /**
+     * Get the spaceships the next tick updates. Every moving spaceship is among them.
+     * @return The awake spaceships, ordered by name.
+     */
+    std::vector<const Spaceship *> getActive() const;
+    /**
+     * Get some of the shuttles with nothing to do: no jobs, not moving and alive.
+     * They are taken from the resting shuttles in order from a cursor, wrapping around once.
+     * @param cursor Where to start, moved past the last shuttle looked at.
+     * @param count The maximal number of shuttles to get.
+     * @return The idle shuttles, ordered by name from the cursor.
+     */
+    std::vector<Shuttle *> getIdleShuttles(std::pair<uint64_t, uint32_t> &cursor, size_t count) const;
+    /**
+     * Get the dead spaceships that are not archived yet.
+     * @return The spaceships, in the order they died.
+     */
+    std::vector<const Spaceship *> getDying() const;
+    /**
+     * Find the spaceships within a radius of a center.
+     * @param center The center.
+     * @param radius The radius in the units of positions.
+     * @param found Receives the spaceships, in no particular order.
+     */
+    void findSpaceships(const Object::Point &center, double radius, std::vector<const Spaceship *> &found) const;
     const std::set<std::shared_ptr<Site>, ObjectComparator> &getSites() const;
-    const std::set<std::shared_ptr<Agent>, AgentComparator> &getAgents() const;
+    /**
+     * Get the dead spaceships, which leave getSpaceships at the end of the tick they stand still in.
+     * @return The wrecks by the names of their spaceships.
+     */
+    const Archive &getWrecks() const;
+    /**
+     * Get the agents that drive no spaceship.
+     * @return The unassigned agents, ordered by name.
+     */
+    std::vector<const Agent *> getAgents() const;
     const std::vector<std::shared_ptr<Destroyer::Rocket>> &getRockets() const;
+    const SiteIndex &getSiteIndex() const;
+    const Economy &getEconomy() const;
+    Dispatcher &getDispatcher();
+    /**
+     * Get the timings of the phases of the recent ticks.
+     * @return The profiler.
+     */
+    const Profiler &getProfiler() const;
+    /**
+     * Get the number of ticks the world has run.
+     * @return The time.
+     */
+    size_t getTime() const;
+    double getBlastRadius() const;
+    /**
+     * Set how close a rocket has to pass by a falcon to destroy it.
+     * @param radius The radius in the units of positions. 0 means a direct hit.
+     * @throw std::invalid_argument if the radius is negative.
+     */
+    void setBlastRadius(double radius);
+    /**
+     * Make room for entities of a type up front, so creating them does not grow their pool.
+     * @param type The type of the entities.
+     * @param count The number of entities to make room for.
+     */
+    void reserve(Pooled type, size_t count);
+    const EntityPool &getPool(Pooled type) const;
     void update();
-    void createShuttle(const std::string &name, const std::string &agentName, double x, double y);
-    void createBomber(const std::string &name, const std::string &agentName, const std::string &siteName);
-    void createDestroyer(const std::string &name, const std::string &agentName, double x, double y);
-    void createFalcon(const std::string &name, double x, double y);
-    void createAgent(const std::string &name, const AgentFactory &factory);
-    void createShipman(const std::string &name);
-    void createCommander(const std::string &name);
-    void createAdmiral(const std::string &name);
-    void createFortressStar(const std::string &name, double x, double y, size_t count);
-    void createSpaceStation(const std::string &name, double x, double y, size_t count, size_t productionRate);
-    void course(const std::string &name, double angle) const;
-    void course(const std::string &name, double angle, double speed) const;
-    void position(const std::string &name, double x, double y) const;
-    void position(const std::string &name, double x, double y, double speed) const;
-    void destination(const std::string &name, const std::string &destination) const;
-    void stop(const std::string &name) const;
-    void attack(const std::string &attackerName, const std::string &attackedName) const;
-    void shoot(const std::string &name, double x, double y) const;
-    void transport(const std::string &spaceshipName, const std::string &stationName, const std::string &starName) const;
-    const std::shared_ptr<Spaceship> &findSpaceship(const std::string &name) const;
-    const std::shared_ptr<Site> &findSite(const std::string &name) const;
-    const std::shared_ptr<Agent> &findAgent(const std::string &name) const;
-    void explode(const Destroyer::Rocket &rocket);
+    /**
+     * Run the rocket phase of a tick against falcons that live in other worlds.
+     * @param targets The live falcons and the paths they flew this tick.
+     * @return The names of the falcons the rockets destroyed.
+     */
+    std::vector<Symbol> updateRockets(const std::vector<Target> &targets);
+    /**
+     * Get the paths the rockets will sweep in the next tick, up to snapping onto their targets.
+     * @return One path per rocket.
+     */
+    std::vector<SweepGrid::Sweep> rocketPaths() const;
+    /**
+     * Take the rockets out of the world, so another world can fly them.
+     * @return The rockets, in the order they were shot.
+     */
+    std::vector<std::shared_ptr<Destroyer::Rocket>> takeRockets();
+    /**
+     * Remove a spaceship from the world and release its agent.
+     * @param name The name of the spaceship.
+     * @throw std::out_of_range if there is no such spaceship.
+     */
+    void remove(Symbol name);
+    /**
+     * Get the state of a spaceship, so a copy of it can be inserted into a world holding the same sites.
+     * @param name The name of the spaceship.
+     * @return The state.
+     * @throw std::out_of_range if there is no such spaceship.
+     */
+    std::string save(Symbol name) const;
+    /**
+     * Remove a spaceship from the world and get its state, so it can be inserted into a world holding the same sites.
+     * @param name The name of the spaceship.
+     * @return The state.
+     * @throw std::out_of_range if there is no such spaceship.
+     */
+    std::string extract(Symbol name);
+    /**
+     * Create spaceships from states written by extract, creating their agents if they are missing.
+     * The states are restored after every spaceship exists, so a falcon may come with its victim.
+     * @param states The states.
+     * @throw std::invalid_argument if a state is malformed or names a spaceship that already exists.
+     */
+    void insert(const std::vector<std::string> &states);
+    void createShuttle(Symbol name, Symbol agentName, double x, double y);
+    void createBomber(Symbol name, Symbol agentName, Symbol siteName);
+    void createDestroyer(Symbol name, Symbol agentName, double x, double y);
+    void createFalcon(Symbol name, double x, double y);
+    void createAgent(Symbol name, const AgentFactory &factory);
+    void createShipman(Symbol name);
+    void createCommander(Symbol name);
+    void createAdmiral(Symbol name);
+    void createFortressStar(Symbol name, double x, double y, size_t count);
+    void createSpaceStation(Symbol name, double x, double y, size_t count, size_t productionRate);
+    void course(Symbol name, double angle) const;
+    void course(Symbol name, double angle, double speed) const;
+    void position(Symbol name, double x, double y) const;
+    void position(Symbol name, double x, double y, double speed) const;
+    void destination(Symbol name, Symbol destination) const;
+    void stop(Symbol name) const;
+    void attack(Symbol attackerName, Symbol attackedName) const;
+    void shoot(Symbol name, double x, double y) const;
+    void transport(Symbol spaceshipName, Symbol stationName, Symbol starName) const;
+    /**
+     * Find a live spaceship, or a dead one until it is archived.
+     * @param name The name of the spaceship.
+     * @return The spaceship.
+     * @throw std::out_of_range if there is no such spaceship.
+     * @throw std::runtime_error if the spaceship is dead and archived.
+     */
+    Spaceship &findSpaceship(Symbol name) const;
+    /**
+     * Find the wreck of an archived spaceship.
+     * @param name The name of the spaceship.
+     * @return The wreck, nullptr if the spaceship was not archived.
+     */
+    Wreck *findWreck(Symbol name);
+    Site &findSite(Symbol name) const;
+    Agent &findAgent(Symbol name) const;
+    /**
+     * Resolve a handle held by an entity.
+     * @param handle The handle to resolve.
+     * @return The entity, nullptr if it no longer exists.
+     */
+    Spaceship *resolve(const Handle<Spaceship> &handle) const;
+    Site *resolve(const Handle<Site> &handle) const;
+    Agent *resolve(const Handle<Agent> &handle) const;
+    /**
+     * Update a sleeping spaceship again from the next tick on, or from later in this tick if it comes after the one updating.
+     * @param spaceship The spaceship, which wakes itself when it is acted on.
+     */
+    void wake(const Spaceship &spaceship);
     void addRocket(const Destroyer::Rocket &rocket);
-    void takeAgent(const std::string &name);
-    bool isBomberNearby(const Object::Point &point);
+    void takeAgent(Symbol name);
+    void releaseAgent(Symbol name);
+    /**
+     * Check if an agent drives a spaceship.
+     * @param name The name of the agent.
+     * @return true if it is assigned, false otherwise.
+     * @throw std::out_of_range if there is no such agent.
+     */
+    bool isAssigned(Symbol name) const;
+    /**
+     * Tell if a bomber is within 250 of a point, looking only in the grid cells around it.
+     * @param point The point.
+     * @return True if one is.
+     */
+    bool isBomberNearby(const Object::Point &point) const;
+    /**
+     * Archive a spaceship that died at the end of the tick, once it stands still.
+     * @param spaceship The dead spaceship.
+     */
+    void recordDeath(const Spaceship &spaceship);
+    /**
+     * Tell the dispatcher a shuttle is done with the station of its first job, by loading there or by dropping the job.
+     * @param shuttle The shuttle.
+     */
+    void releaseStation(const Spaceship &shuttle);
+    void recordDelivery(size_t count);
+    void recordTheft(size_t count);
 private:
-    Model();
-    static std::shared_ptr<Model> instance;
+    void updateRockets();
+    /**
+     * Move the rockets along their paths for this tick.
+     * @return The paths they swept.
+     */
+    std::vector<SweepGrid::Sweep> advanceRockets();
+    /**
+     * Detonate the rockets that met a falcon along their path this tick or reached their target, and drop them.
+     * A rocket explodes at the first moment a live falcon is within the blast radius, destroying the falcons touched then.
+     * A rocket that reaches its target without touching one destroys the falcons within the blast radius of it.
+     * @param paths The paths the rockets swept this tick.
+     * @param targetPaths The paths the live falcons flew this tick.
+     * @return For every falcon, whether a rocket destroyed it.
+     */
+    std::vector<bool> collide(const std::vector<SweepGrid::Sweep> &paths, const std::vector<SweepGrid::Sweep> &targetPaths);
+    /**
+     * Move the spaceships that died and stand still out of the containers the ticks and queries walk into wrecks.
+     */
+    void archive();
+    /**
+     * Take a spaceship out of every container of live entities, without releasing its agent.
+     * @param spaceship The spaceship.
+     */
+    void erase(Spaceship &spaceship);
+    /**
+     * Check that no spaceship, live or dead, has a name yet.
+     * @param name The name.
+     * @throw std::invalid_argument if one has.
+     */
+    void checkName(Symbol name) const;
+    void add(const std::shared_ptr<Spaceship> &spaceship);
+    /**
+     * Give a spaceship just added to spaceships its place between its neighbors, renumbering every spaceship
+     * if there is no room between them.
+     * @param position The spaceship in spaceships.
+     */
+    void order(std::set<std::shared_ptr<Spaceship>, ObjectComparator>::const_iterator position);
+    void add(const std::shared_ptr<Site> &site);
+    /**
+     * Declared before every container of entities, so the memory outlives the entities in it.
+     */
+    std::array<EntityPool, POOLS> pools;
     std::set<std::shared_ptr<Spaceship>, ObjectComparator> spaceships;
+    /**
+     * The spaceships update may change, by their places and their slots in spaceshipRegistry, so they update
+     * in the same order as spaceships and waking one compares integers only. A spaceship falls asleep when it is steady
+     * after its update, so a tick costs as much as the spaceships that move or have work, not the whole population.
+     */
+    std::set<std::pair<uint64_t, uint32_t>> active;
+    /**
+     * The places of the spaceships by slot, increasing in the order of spaceships with gaps between them.
+     */
+    std::vector<uint64_t> places;
+    /**
+     * The shuttles that fell asleep, like active. An idle shuttle stands still, so it is here from the tick after it became idle,
+     * and the dispatcher finds it without walking the fleet.
+     */
+    std::set<std::pair<uint64_t, uint32_t>> resting;
+    std::array<std::set<std::shared_ptr<Spaceship>, ObjectComparator>, 4> fleets;
+    /**
+     * The live spaceships by their slots in spaceshipRegistry. Only update and insert move spaceships,
+     * so they keep it up to date.
+     */
+    PointGrid spaceshipGrid;
     std::set<std::shared_ptr<Site>, ObjectComparator> sites;
-    std::set<std::shared_ptr<Agent>, AgentComparator> agents;
+    std::vector<Handle<Spaceship>> deaths;
+    Archive wrecks;
+    SiteIndex siteIndex;
+    AgentRegistry agents;
     std::vector<std::shared_ptr<Destroyer::Rocket>> rockets;
+    Registry<Spaceship> spaceshipRegistry;
+    Registry<Site> siteRegistry;
+    std::unordered_map<Symbol, Handle<Spaceship>> spaceshipNames;
+    std::unordered_map<Symbol, Handle<Site>> siteNames;
+    Economy economy;
+    size_t time;
+    size_t productionRate;
+    Dispatcher dispatcher;
+    std::vector<Handle<Spaceship>> falcons;
+    std::vector<Object::Point> falconStarts;
+    SweepGrid sweepGrid;
+    double blastRadius;
+    Profiler profiler;
 };
 
 #endif //HW03_MODEL_H
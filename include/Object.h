@@ -3,6 +3,8 @@
 
 #include <cfloat>
 #include <utility>
+#include "Coordinate.h"
+#include "Symbol.h"
 #include "Vector.h"
 
 class Object {
@@ -12,31 +14,33 @@ public:
     virtual void print(std::ostream &stream) const;
     virtual void printType(std::ostream &stream) const;
     const std::string &getName() const;
-    [[nodiscard]] const Point &getLocation() const;
+    Symbol getSymbol() const;
+    [[nodiscard]] Point getLocation() const;
     void setLocation(const Point &point);
 protected:
-    explicit Object(std::string name, Point location);
+    explicit Object(Symbol name, Point location);
     virtual ~Object() = default;
 private:
-    std::string name;
-    Point location;
+    Symbol name;
+    Coordinate::Stored location;
 };
 
 std::ostream &operator<<(std::ostream &stream, const Object &object);
 
 class MovingObject : public Object {
 public:
-    explicit MovingObject(const std::string &name, double speed, const Point &location);
+    explicit MovingObject(Symbol name, double speed, const Point &location);
     ~MovingObject() override = default;
     void update() override;
-    [[nodiscard]] const Point &getDestination() const;
+    [[nodiscard]] Point getDestination() const;
     virtual void go(const Point &point);
     void print(std::ostream &stream) const override;
     void printType(std::ostream &stream) const override;
     void setSpeed(double s);
     double getSpeed() const;
+    void advanceTo(const Point &point);
 private:
-    Point destination;
+    Coordinate::Stored destination;
     double speed;
 };
 
@@ -0,0 +1,56 @@
+#ifndef HW03_POINTGRID_H
+#define HW03_POINTGRID_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Object.h"
+
+/**
+ * A uniform hash grid over points with dense ids, kept up to date as the points move.
+ * Moving a point within its cell only stores the new point, so moving every point that flew in a tick is cheap.
+ * A radius query visits the cells its box covers, or every occupied cell if there are fewer of those.
+ */
+class PointGrid {
+public:
+    /**
+     * Constructs an empty grid.
+     * @param cell The side of a cell.
+     */
+    explicit PointGrid(double cell);
+    /**
+     * Add a point.
+     * @param id The id of the point, not in the grid yet.
+     * @param point The point.
+     */
+    void insert(uint32_t id, const Object::Point &point);
+    /**
+     * Move a point, moving it to another cell if it left its own.
+     * @param id The id of the point.
+     * @param point Where it is now.
+     */
+    void move(uint32_t id, const Object::Point &point);
+    void erase(uint32_t id);
+    /**
+     * Find the points within a radius of a center.
+     * @param center The center.
+     * @param radius The radius.
+     * @param ids Receives the ids of the points found, in no particular order.
+     */
+    void within(const Object::Point &center, double radius, std::vector<uint32_t> &ids) const;
+private:
+    struct Entry {
+        Object::Point point;
+        uint64_t cell;
+        uint32_t slot;
+        bool present;
+    };
+    int64_t cellOf(double coordinate) const;
+    uint64_t keyOf(const Object::Point &point) const;
+    static uint64_t key(int64_t x, int64_t y);
+    double cell;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+    std::vector<Entry> entries;
+};
+
+#endif //HW03_POINTGRID_H
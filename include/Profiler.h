@@ -0,0 +1,113 @@
+#ifndef HW03_PROFILER_H
+#define HW03_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include "Tracer.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PROFILER_TSC
+#include <x86intrin.h>
+#endif
+
+/**
+ * Times the phases of Model::update and keeps the last window ticks of every phase for percentiles.
+ * Timestamps are read from the time stamp counter where there is one, which costs a few nanoseconds,
+ * so even a per-spaceship split stays cheap. Compiling with DISABLE_PROFILER turns every timer into nothing.
+ * Scoped phases are also traced as spans while the Tracer is on.
+ */
+class Profiler {
+public:
+    enum Phase {TICK, DISPATCH, SPACESHIPS, SHUTTLES, BOMBERS, DESTROYERS, FALCONS, ROCKETS, PHASES};
+#ifdef DISABLE_PROFILER
+    static constexpr bool enabled = false;
+#else
+    static constexpr bool enabled = true;
+#endif
+    static constexpr size_t window = 1024;
+    static constexpr const char *names[PHASES] = {"Tick", "Dispatch", "Spaceships", "Shuttles", "Bombers", "Destroyers", "Falcons", "Rockets"};
+    /**
+     * Times a phase from its construction to its destruction.
+     */
+    class Scope {
+    public:
+        Scope(Profiler &profiler, Phase phase) : profiler(profiler), phase(phase), start(0), span(names[phase], "tick") {
+            if constexpr (enabled) start = now();
+        }
+        ~Scope() {
+            if constexpr (enabled) profiler.record(phase, now() - start);
+        }
+        Scope(const Scope &scope) = delete;
+        Scope &operator=(const Scope &scope) = delete;
+    private:
+        Profiler &profiler;
+        Phase phase;
+        uint64_t start;
+        Tracer::Span span;
+    };
+    /**
+     * Splits a loop between sub-phases. The time of a run of iterations is charged to the sub-phase they entered,
+     * so the clock is only read when the sub-phase changes. Each sub-phase records its total once the split ends.
+     */
+    class Split {
+    public:
+        explicit Split(Profiler &profiler) : profiler(profiler), totals(), entered(), current(PHASES), last(0) {
+
+        }
+        void enter(Phase phase) {
+            if constexpr (enabled) {
+                if (phase == current) return;
+                uint64_t time = now();
+                if (current != PHASES) totals[current] += time - last;
+                entered[phase] = true;
+                current = phase;
+                last = time;
+            }
+        }
+        ~Split() {
+            if constexpr (enabled) {
+                if (current != PHASES) totals[current] += now() - last;
+                for (size_t phase = 0; phase < PHASES; ++phase) {
+                    if (entered[phase]) profiler.record((Phase)phase, totals[phase]);
+                }
+            }
+        }
+        Split(const Split &split) = delete;
+        Split &operator=(const Split &split) = delete;
+    private:
+        Profiler &profiler;
+        std::array<uint64_t, PHASES> totals;
+        std::array<bool, PHASES> entered;
+        Phase current;
+        uint64_t last;
+    };
+    Profiler();
+    /**
+     * Print p50, p99 and max of every phase that was timed, in microseconds, and the tick rate.
+     * @param stream The stream to print to.
+     */
+    void print(std::ostream &stream) const;
+    static const char *name(Phase phase) {
+        return names[phase];
+    }
+private:
+    static uint64_t now() {
+#ifdef PROFILER_TSC
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+    void record(Phase phase, uint64_t time);
+    /**
+     * Get how many timestamp units pass in a nanosecond, measured once over 10 ms on the first call.
+     * @return The units per nanosecond.
+     */
+    static double rate();
+    std::array<std::vector<uint64_t>, PHASES> samples;
+    std::array<size_t, PHASES> counts;
+};
+
+#endif //HW03_PROFILER_H
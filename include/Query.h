@@ -0,0 +1,90 @@
+#ifndef HW03_QUERY_H
+#define HW03_QUERY_H
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Model.h"
+
+/**
+ * A filtered, paged listing of the entities of a world:
+ * query <shuttle|bomber|destroyer|falcon|spaceship|station|fortress|site> [status <stopped|moving|docked|dead>]
+ *       [within <distance> <site_name|(<x>, <y>)>] [toward <site_name>] [<crystals|health> <op> <value>]... [page <number> [<size>]]
+ * The candidates come from the narrowest index the world keeps for the filters: the spatial grids for a region,
+ * the awake spaceships for moving ones, the dying spaceships for dead ones, the fleets for a kind.
+ * Only the entities on the requested page are formatted.
+ */
+class Query {
+public:
+    enum Type {SHUTTLE, BOMBER, DESTROYER, FALCON, SPACESHIP, STATION, FORTRESS, SITE};
+    /**
+     * The matches of a query, or of the part of a world one shard holds.
+     */
+    struct Result {
+        size_t total;
+        /**
+         * The names and lines of the first matches by name, up to the end of the requested page.
+         */
+        std::vector<std::pair<std::string, std::string>> lines;
+    };
+    /**
+     * Parse a query command.
+     * @param args The command, starting with query.
+     * @param model The world, whose sites the query may name.
+     * @throw std::invalid_argument if the command is malformed.
+     * @throw std::out_of_range if it names a site that does not exist.
+     */
+    Query(const std::vector<std::string> &args, const Model &model);
+    /**
+     * Find the matches in a world.
+     * @param model The world.
+     * @param format The stream whose format the lines are printed in.
+     * @param includes Tells if a site counts, so every site is counted once across shards. Empty to count all.
+     * @return The number of matches and the lines of those up to the end of the page.
+     */
+    Result match(const Model &model, const std::ostream &format, const std::function<bool(const Site &)> &includes = {}) const;
+    /**
+     * Print the requested page of the matches and a footer with the page and match counts.
+     * @param result The matches, ordered by name.
+     * @param output The stream to print to.
+     */
+    void print(const Result &result, std::ostream &output) const;
+private:
+    enum Field {CRYSTALS, HEALTH};
+    enum Operator {LESS, LESS_EQUAL, EQUAL, NOT_EQUAL, GREATER_EQUAL, GREATER};
+    struct Predicate {
+        Field field;
+        Operator op;
+        double value;
+        bool holds(size_t actual) const;
+    };
+    static constexpr size_t defaultPageSize = 20;
+    static constexpr size_t maxPage = 1000000000;
+    static size_t parseCount(const std::string &arg, const std::string &what);
+    bool isSpaceship() const;
+    bool matches(Spaceship::Kind kind) const;
+    bool matches(const Spaceship &spaceship) const;
+    bool matches(const Wreck &wreck) const;
+    bool matches(const Site &site) const;
+    /**
+     * Get the number of matches to keep, the end of the requested page.
+     * @return The limit.
+     */
+    size_t limit() const;
+    Type type;
+    bool hasStatus;
+    Spaceship::Status status;
+    bool hasRegion;
+    Object::Point center;
+    double radius;
+    bool hasToward;
+    Object::Point toward;
+    std::vector<Predicate> predicates;
+    size_t page;
+    size_t pageSize;
+};
+
+#endif //HW03_QUERY_H
@@ -0,0 +1,115 @@
+#ifndef HW03_SERVER_H
+#define HW03_SERVER_H
+
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Controller.h"
+#include "TickClock.h"
+
+/**
+ * Runs a world in real time on a single thread around epoll. The world ticks by itself at a fixed rate, paced by
+ * a TickClock, and serves many clients over a Unix domain socket or a localhost TCP port, or the console alone.
+ * The commands read from all clients between two ticks form the batch of the next tick, applied at the tick boundary
+ * ordered by client, in the order they connected, and then by the order each client sent them, so the outcome
+ * does not depend on which socket epoll reported first.
+ * Every client gets the output and errors of its own commands, each followed by the prompt, as on the console.
+ * exit ends a client, go is refused because the clock advances the time, and clock reports the pacing.
+ * A server runs until it gets SIGINT or SIGTERM, the console until exit or the end of its input.
+ */
+class Server {
+public:
+    /**
+     * Constructs a server of a world of its own.
+     * @param address A port to listen on at 127.0.0.1, the path of a Unix domain socket, or empty to serve the console.
+     * @param rate The ticks per second.
+     * @param catchUp The most ticks run at once after a stall.
+     * @param log The stream connections and the pacing are reported to.
+     * @throw std::invalid_argument if the rate is not positive or catchUp is 0.
+     */
+    Server(const std::string &address, double rate, size_t catchUp, std::ostream &log);
+    ~Server();
+    Server(const Server &server) = delete;
+    Server &operator=(const Server &server) = delete;
+    /**
+     * Load the sites file and run the world until the server is interrupted or the console ends.
+     * @param path The sites file.
+     * @param shards The number of processes to split the world across, 1 to keep it in this one.
+     * @return false if the world could not be loaded or the socket not opened, true otherwise.
+     */
+    bool run(const std::string &path, size_t shards = 1);
+private:
+    /**
+     * A client reads its commands from source and gets its replies on sink, which are the same socket but on the console.
+     * A closing client reads no more and is disconnected once its replies are written.
+     */
+    struct Client {
+        int source;
+        int sink;
+        std::string input;
+        std::string output;
+        bool closing;
+    };
+    struct Command {
+        uint64_t client;
+        size_t sequence;
+        std::string line;
+        TickClock::Clock::time_point received;
+    };
+    /**
+     * The epoll keys of the descriptors that are not clients. Clients are keyed by their id, which counts up from CLIENTS.
+     */
+    enum Key : uint64_t {LISTENER, TIMER, SIGNALS, CLIENTS};
+    /**
+     * A client that sends a longer line without a newline, or reads its replies slower than this, is disconnected.
+     */
+    static constexpr size_t maxLine = 1 << 16;
+    static constexpr size_t maxOutput = 1 << 24;
+    void listen();
+    void watch(int descriptor, uint64_t key, uint32_t events);
+    void accept();
+    /**
+     * Add a client and greet it with the prompt.
+     * @param source The descriptor to read commands from.
+     * @param sink The descriptor to write replies to.
+     */
+    void connect(int source, int sink);
+    void read(uint64_t id);
+    void write(uint64_t id);
+    /**
+     * Stop reading from a client that sent exit or reached the end of its input.
+     * Its commands still in the batch are applied and it is disconnected once its replies are written.
+     */
+    void finish(uint64_t id);
+    void disconnect(uint64_t id);
+    /**
+     * Arm the timer for the next tick the clock has due.
+     */
+    void schedule();
+    /**
+     * Apply the batch and advance the world by one tick.
+     */
+    void tick();
+    bool isConsole() const;
+    std::string address;
+    double rate;
+    std::ostream &log;
+    std::istringstream input;
+    std::ostringstream output;
+    Controller controller;
+    TickClock clock;
+    int epoll;
+    int listener;
+    int timer;
+    int signals;
+    int consoleFlags;
+    std::map<uint64_t, Client> clients;
+    std::vector<Command> batch;
+    uint64_t nextClient;
+    size_t sequence;
+    bool running;
+};
+
+#endif //HW03_SERVER_H
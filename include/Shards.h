@@ -0,0 +1,144 @@
+#ifndef HW03_SHARDS_H
+#define HW03_SHARDS_H
+
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+#include "Channel.h"
+#include "Model.h"
+#include "Query.h"
+
+/**
+ * Splits a world across processes by space. Every shard is a child process with a world of its own, which loads
+ * the same sites and owns the spaceships in one vertical strip of the map. The hub, the process reading the commands,
+ * keeps the agents and the rockets, knows the owner of every spaceship and forwards the commands on it to its owner.
+ * A tick takes two rounds over Unix sockets:
+ * - every shard hands over the spaceships that left its strip, and copies of its bombers near another strip,
+ * - every shard takes in the newcomers and the copies, ticks, drops the copies and reports the falcons near a rocket.
+ * The hub then flies the rockets and tells the owners which falcons were destroyed.
+ * A spaceship only interacts with the site it is at and a falcon with its victim, so a falcon moves to the shard
+ * of its victim when it attacks, and the copies cover the bombers guarding a shuttle across a border.
+ * Everything but the dispatcher and the map works as in a single world and prints the same.
+ */
+class Shards {
+public:
+    /**
+     * The strips of the map, spread evenly over the x range of the sites. The outer strips extend to infinity.
+     */
+    struct Strips {
+        double minX;
+        double width;
+        size_t count;
+        /**
+         * Get the strip a position is in.
+         * @param x The x coordinate of the position.
+         * @return The index of the strip.
+         */
+        size_t of(double x) const;
+        /**
+         * Get how far a position is from a strip.
+         * @param strip The index of the strip.
+         * @param x The x coordinate of the position.
+         * @return The horizontal distance, 0 inside the strip.
+         */
+        double distance(size_t strip, double x) const;
+    };
+    /**
+     * Fork the shards. Every one of them loads the sites file and serves the hub until the hub destroys them.
+     * @param hub The world of the hub, already holding the sites.
+     * @param path The sites file.
+     * @param count The number of shards.
+     * @throw std::runtime_error if a shard cannot be started.
+     */
+    Shards(Model &hub, const std::string &path, size_t count);
+    ~Shards();
+    Shards(const Shards &shards) = delete;
+    Shards &operator=(const Shards &shards) = delete;
+    /**
+     * Check if a type of the create command is a spaceship, which the hub leaves to a shard.
+     * @param type The type.
+     * @return true for spaceships, false for agents.
+     */
+    static bool creates(const std::string &type);
+    /**
+     * Create a spaceship in the shard of its position.
+     * @param args The create command.
+     * @param output The stream results are written to.
+     * @throw std::runtime_error with the error of the shard if the spaceship was not created.
+     */
+    void create(const std::vector<std::string> &args, std::ostream &output);
+    /**
+     * Run a command on a spaceship in its shard.
+     * @param args The command.
+     * @param output The stream results are written to.
+     * @throw std::out_of_range if there is no such spaceship.
+     * @throw std::runtime_error with the error of the shard if the command failed.
+     */
+    void command(const std::vector<std::string> &args, std::ostream &output);
+    /**
+     * Run a command in every shard.
+     * @param args The command.
+     * @param output The stream results are written to.
+     * @throw std::runtime_error with the error of a shard if the command failed.
+     */
+    void broadcast(const std::vector<std::string> &args, std::ostream &output);
+    void update();
+    /**
+     * Print the spaceships and sites of all shards, then the agents and rockets of the hub, as status does.
+     * @param output The stream to print to.
+     */
+    void status(std::ostream &output);
+    /**
+     * Answer a query from the matches of all shards, every site counted by the shard of its strip.
+     * @param query The parsed query.
+     * @param args The query command, which every shard parses again.
+     * @param output The stream to print to.
+     */
+    void query(const Query &query, const std::vector<std::string> &args, std::ostream &output);
+    Model::Economy economy();
+    /**
+     * Count the spaceships of all shards and print the profiler of every shard.
+     * @param kinds Receives the number of spaceships of each kind.
+     * @param output The stream to print the profilers to.
+     */
+    void stats(size_t kinds[], std::ostream &output);
+private:
+    /**
+     * How close to a strip a bomber is copied into its shard: a shuttle starts the tick in the strip and flies
+     * at most 300 before it is attacked, while the bomber flies at most 1000 and guards 250 around itself.
+     */
+    static constexpr double halo = 2000;
+    /**
+     * Serve the hub in a shard process until it says exit.
+     * @param channel The channel to the hub.
+     * @param path The sites file.
+     * @param strips The strips of the map.
+     * @param index The strip of the shard.
+     */
+    static void serve(Channel &channel, const std::string &path, const Strips &strips, size_t index);
+    std::vector<std::string> request(size_t shard, const std::vector<std::string> &fields);
+    /**
+     * Run a command in a shard, with the agent it names in the same state as in the hub.
+     * @param shard The shard.
+     * @param args The command.
+     * @param agentName The agent the command assigns, empty if none.
+     * @param output The stream results are written to.
+     * @throw std::runtime_error with the error of the shard if the command failed.
+     */
+    void forward(size_t shard, const std::vector<std::string> &args, const std::string &agentName, std::ostream &output);
+    /**
+     * Move a spaceship to another shard.
+     * @param name The name of the spaceship.
+     * @param shard The shard to move it to.
+     */
+    void move(Symbol name, size_t shard);
+    Model &hub;
+    Strips strips;
+    std::vector<Channel> channels;
+    std::vector<pid_t> children;
+    std::unordered_map<Symbol, size_t> owners;
+};
+
+#endif //HW03_SHARDS_H
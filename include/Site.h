@@ -3,36 +3,57 @@
 
 #include <cstddef>
 #include <memory>
+#include "Handle.h"
 #include "Object.h"
 #include "Utilities.h"
 
+class Model;
+
 class Site : public Object {
 public:
-    void addCrystals(size_t count);
-    [[nodiscard]] size_t removeCrystals(size_t count);
+    virtual void addCrystals(size_t count);
+    [[nodiscard]] virtual size_t removeCrystals(size_t count);
     void print(std::ostream &stream) const override;
     void printType(std::ostream &stream) const override;
-    size_t getCrystals() const;
+    virtual size_t getCrystals() const;
+    Handle<Site> getHandle() const;
+    void setHandle(const Handle<Site> &h);
 protected:
-    explicit Site(const std::string &name, size_t count, const Point &location);
+    explicit Site(Symbol name, size_t count, const Point &location);
     virtual ~Site();
 private:
     size_t crystals;
+    Handle<Site> handle;
 };
 
+/**
+ * A station produces its crystals in closed form instead of on every tick: its stock is the crystals stored at the
+ * time it was last touched plus the rate times the ticks of its world since then. Docking settles the production
+ * into the stored crystals, reading the stock computes it, so an idle station costs nothing per tick.
+ */
 class SpaceStation : public Site {
 public:
-    explicit SpaceStation(const std::string &name, const Point &location, size_t count, size_t productionRate);
+    explicit SpaceStation(const Model &world, Symbol name, const Point &location, size_t count, size_t productionRate);
     void update() override;
+    void addCrystals(size_t count) override;
+    [[nodiscard]] size_t removeCrystals(size_t count) override;
     void print(std::ostream &stream) const override;
     void printType(std::ostream &stream) const override;
+    size_t getCrystals() const override;
+    size_t getProductionRate() const;
 private:
+    /**
+     * Store the crystals produced since the station was last touched.
+     */
+    void settle();
+    const Model &world;
     size_t productionRate;
+    size_t since;
 };
 
 class FortressStar : public Site {
 public:
-    explicit FortressStar(const std::string &name, const Point &location, size_t count);
+    explicit FortressStar(Symbol name, const Point &location, size_t count);
     void update() override;
     void print(std::ostream &stream) const override;
     void printType(std::ostream &stream) const override;
@@ -0,0 +1,153 @@
+#ifndef HW03_SITEINDEX_H
+#define HW03_SITEINDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Site.h"
+
+/**
+ * A static k-d tree over site locations. Sites never move, so the tree is only rebuilt after sites are added.
+ * Every site gets a stable id in insertion order.
+ */
+class SiteIndex {
+public:
+    /**
+     * A compact set of site ids, one bit per site.
+     */
+    class Visited {
+    public:
+        /**
+         * Constructs a set where every site with an id of size or above counts as visited.
+         * @param size The number of sites that can be unvisited.
+         */
+        explicit Visited(size_t size = 0);
+        /**
+         * Constructs a set that also counts the unvisited sites under every node of the tree of an index,
+         * so searches of that tree skip the subtrees that were fully visited.
+         * @param index The index the set is searched with.
+         * @param size The number of sites that can be unvisited.
+         */
+        Visited(const SiteIndex &index, size_t size);
+        bool contains(size_t id) const;
+        void insert(size_t id);
+        /**
+         * Get the number of sites that can be unvisited.
+         * @return The size the set was constructed with.
+         */
+        size_t getSize() const;
+    private:
+        friend class SiteIndex;
+        /**
+         * Count a site in or out of every node on the path from the root of the tree to it.
+         * @param id The id of the site.
+         * @param visit True to count it out.
+         */
+        void count(size_t id, bool visit);
+        /**
+         * The unvisited sites under every node, kept behind a pointer so a set that does not count stays small.
+         */
+        struct Counts {
+            /**
+             * The tree positions of the sites when the counts were taken.
+             */
+            std::shared_ptr<const std::vector<uint32_t>> positions;
+            std::vector<uint32_t> unvisited;
+        };
+        std::vector<uint64_t> bits;
+        size_t size;
+        std::unique_ptr<Counts> counts;
+    };
+    /**
+     * A greedy nearest-neighbour patrol from a start site, as a sequence of site ids.
+     */
+    struct Tour {
+        size_t start;
+        size_t sites;
+        std::vector<uint32_t> order;
+        /**
+         * Get the sites visited after a number of legs.
+         * @param index The index the tour was planned on.
+         * @param legs The number of legs flown.
+         * @return The start and the first legs sites of the tour.
+         */
+        Visited visited(const SiteIndex &index, size_t legs) const;
+    };
+    SiteIndex();
+    void add(const std::shared_ptr<Site> &site);
+    size_t size() const;
+    const std::shared_ptr<Site> &get(size_t id) const;
+    /**
+     * Get the id of a site.
+     * @param site The site.
+     * @return Its id.
+     * @throw std::out_of_range if the site is not indexed.
+     */
+    size_t find(const Site &site) const;
+    /**
+     * Find the closest site that was not visited.
+     * @param point The point to search from.
+     * @param visited The sites to skip.
+     * @return The id of the closest site, the lowest one on ties. size() if every site was visited.
+     */
+    size_t nearest(const Object::Point &point, const Visited &visited) const;
+    /**
+     * Find the closest sites that were not visited.
+     * @param point The point to search from.
+     * @param count The maximal number of sites to find.
+     * @param visited The sites to skip.
+     * @return Up to count ids, closest first.
+     */
+    std::vector<size_t> nearest(const Object::Point &point, size_t count, const Visited &visited) const;
+    /**
+     * Find a site that was not visited located exactly at a point.
+     * @param point The point to search at.
+     * @param visited The sites to skip.
+     * @return The lowest id located at the point, size() if there is none.
+     */
+    size_t at(const Object::Point &point, const Visited &visited) const;
+    /**
+     * Find the sites within a radius of a point.
+     * @param point The center.
+     * @param radius The radius.
+     * @return The ids of the sites, in no particular order.
+     */
+    std::vector<size_t> within(const Object::Point &point, double radius) const;
+    /**
+     * Get the patrol from a start site. It is computed once and shared until sites are added.
+     * @param start The id of the start site.
+     * @return The tour.
+     */
+    std::shared_ptr<const Tour> tour(size_t start) const;
+private:
+    struct Node {
+        double coordinates[2];
+        uint32_t id;
+    };
+    void build() const;
+    void build(size_t begin, size_t end, size_t axis) const;
+    /**
+     * Get the tree positions of the sites, shared by the visited sets that count under the current tree.
+     * @return The position of every site id.
+     */
+    std::shared_ptr<const std::vector<uint32_t>> layout() const;
+    /**
+     * Tell if a subtree holds only visited sites, when the visited set counts under the current tree.
+     * @param visited The visited sites.
+     * @param middle The position of the root of the subtree.
+     * @return True if it can be skipped.
+     */
+    bool exhausted(const Visited &visited, size_t middle) const;
+    void search(size_t begin, size_t end, size_t axis, const double *point, const Visited &visited, double &best, size_t &closest) const;
+    void search(size_t begin, size_t end, size_t axis, const double *point, const Visited &visited, size_t count, std::vector<std::pair<double, size_t>> &closest) const;
+    void collect(size_t begin, size_t end, size_t axis, const double *point, double radius, std::vector<size_t> &found) const;
+    std::vector<std::shared_ptr<Site>> sites;
+    std::unordered_map<const Site *, size_t> ids;
+    mutable std::vector<Node> tree;
+    mutable std::shared_ptr<const std::vector<uint32_t>> positions;
+    mutable std::unordered_map<size_t, std::shared_ptr<const Tour>> tours;
+    mutable bool dirty;
+};
+
+#endif //HW03_SITEINDEX_H
@@ -1,71 +1,137 @@
 #ifndef HW03_SPACESHIP_H
 #define HW03_SPACESHIP_H
 
+#include <cstdint>
 #include <memory>
-#include <queue>
-#include <set>
+#include <vector>
 #include "Agent.h"
+#include "Handle.h"
 #include "Site.h"
+#include "SiteIndex.h"
+
+class Model;
+class Wreck;
 
 class Spaceship : public MovingObject {
 public:
     enum Status {STOPPED, MOVING, DOCKED, DEAD};
+    enum Kind : uint8_t {SHUTTLE, BOMBER, DESTROYER, FALCON};
     virtual Status status() const;
     void print(std::ostream &stream) const override;
     void printType(std::ostream &stream) const override;
     size_t getHealth() const;
+    Kind getKind() const;
     size_t getCrystals() const;
-    const std::shared_ptr<Agent> &getAgent() const;
+    Agent *getAgent() const;
+    Handle<Spaceship> getHandle() const;
+    void setHandle(const Handle<Spaceship> &h);
+    /**
+     * Get the world the spaceship lives in. Every lookup a spaceship makes goes through it.
+     * @return The owning Model.
+     */
+    Model &getWorld() const;
     void update() override;
+    /**
+     * Check if updating the spaceship changes nothing until a command or another entity acts on it.
+     * @return true if it stands still off course and has nothing left to do, false otherwise.
+     */
+    virtual bool isSteady() const;
+    /**
+     * Mark the spaceship asleep once its world stops updating it. Acting on it wakes it again.
+     */
+    void sleep();
     void go(const Point &point) override;
     virtual void go(const Point &point, double speed);
-    virtual void goTo(const std::shared_ptr<Site> &site);
+    virtual void goTo(Site &site);
     virtual void stop();
     virtual void hurt();
     virtual void heal();
     virtual void die();
-    virtual void add();
-    virtual void remove();
+    virtual size_t add(size_t count);
+    virtual size_t remove(size_t count);
+    size_t load(Site &from, size_t count);
+    size_t unload(Site &to, size_t count);
     virtual void course(double angle);
     virtual void course(double angle, double speed);
     virtual void shoot(const Point &point);
-    virtual void transport(const std::shared_ptr<SpaceStation> &station, const std::shared_ptr<FortressStar> &star);
-    virtual void attack(const std::shared_ptr<Spaceship> &victim);
-    virtual void beAttacked(const std::shared_ptr<Spaceship> &attacker);
+    virtual void transport(SpaceStation &station, FortressStar &star);
+    virtual void attack(Spaceship &victim);
+    /**
+     * Attack a shuttle that died and was archived, as a dead one is attacked.
+     * @param victim The wreck of the shuttle.
+     */
+    virtual void attack(const Wreck &victim);
+    virtual void beAttacked(Spaceship &attacker);
+    size_t crystalsToTake() const;
+    /**
+     * Write the state of the spaceship beyond what its constructor takes, so a copy can be made in another world.
+     * Sites and spaceships are written by name, so the other world only has to hold the same sites.
+     * @param stream The stream to write to.
+     */
+    virtual void save(std::ostream &stream) const;
+    /**
+     * Read back the state written by save into a spaceship constructed with the same arguments.
+     * @param stream The stream to read from.
+     */
+    virtual void restore(std::istream &stream);
 protected:
-    Spaceship(const std::string &name, const std::shared_ptr<Agent> &agent, double speed, size_t health, const Point &location);
+    Spaceship(Model &world, Symbol name, Kind kind, const Handle<Agent> &agent, double speed, size_t health, const Point &location);
     ~Spaceship() override = default;
-    virtual void interact(const std::shared_ptr<SpaceStation> &station);
-    virtual void interact(const std::shared_ptr<FortressStar> &star);
-    size_t crystalsToTake() const;
+    virtual void interact(SpaceStation &station);
+    virtual void interact(FortressStar &star);
+    /**
+     * Have the world update the spaceship again if it sleeps.
+     */
+    void wake();
 private:
     static constexpr size_t maxHealth = 20;
     static constexpr size_t maxCrystals = 5;
-    std::shared_ptr<Agent> agent;
-    std::shared_ptr<Site> site;
-    std::shared_ptr<double> angle;
-    size_t health;
-    size_t crystals;
+    Model &world;
+    Handle<Spaceship> handle;
+    Handle<Agent> agent;
+    Handle<Site> site;
+    /**
+     * The unit direction of the course, cached so update does not recompute sin and cos every tick.
+     * Only meaningful while onCourse is set.
+     */
+    Point heading;
+    double angle;
+    uint8_t health;
+    uint8_t crystals;
+    /**
+     * Bits, so the flags take one byte and leave the tail padding Bomber packs its leg into.
+     */
+    bool onCourse : 1;
+    bool awake : 1;
+    Kind kind;
 };
 
 class Shuttle : public Spaceship {
 public:
-    Shuttle(const std::string &name, const std::string &agentName, const Point &location);
+    Shuttle(Model &world, Symbol name, Symbol agentName, const Point &location);
     ~Shuttle() override = default;
     void print(std::ostream &stream) const override;
     void printType(std::ostream &stream) const override;
     void update() override;
     void go(const Point &point) override;
-    void goTo(const std::shared_ptr<Site> &site) override;
+    void goTo(Site &site) override;
     void stop() override;
     void course(double angle) override;
-    void transport(const std::shared_ptr<SpaceStation> &station, const std::shared_ptr<FortressStar> &star) override;
-    void beAttacked(const std::shared_ptr<Spaceship> &attacker) override;
+    void transport(SpaceStation &station, FortressStar &star) override;
+    void beAttacked(Spaceship &attacker) override;
+    bool isSteady() const override;
+    bool isIdle() const;
+    void save(std::ostream &stream) const override;
+    void restore(std::istream &stream) override;
 private:
-    using Job = std::pair<std::shared_ptr<SpaceStation>, std::shared_ptr<FortressStar>>;
-    void interact(const std::shared_ptr<SpaceStation> &station) override;
-    void interact(const std::shared_ptr<FortressStar> &star) override;
-    std::queue<Job> jobs;
+    using Job = std::pair<Handle<Site>, Handle<Site>>;
+    void interact(SpaceStation &station) override;
+    void interact(FortressStar &star) override;
+    /**
+     * Pending jobs, oldest first. A shuttle rarely queues more than a few jobs,
+     * and unlike a std::queue an empty vector allocates nothing.
+     */
+    std::vector<Job> jobs;
     static const ShipmanFactory factory;
     static constexpr double speed = 300;
     static constexpr size_t startHealth = 10;
@@ -73,17 +139,33 @@ private:
 
 class Bomber : public Spaceship {
 public:
-    Bomber(const std::string &name, const std::string &agentName, const std::shared_ptr<Site> &start);
+    Bomber(Model &world, Symbol name, Symbol agentName, Site &start);
     ~Bomber() override = default;
     void print(std::ostream &stream) const override;
     void printType(std::ostream &stream) const override;
     void update() override;
+    void go(const Point &point) override;
+    void goTo(Site &site) override;
+    void stop() override;
+    void course(double angle) override;
+    bool isSteady() const override;
+    void save(std::ostream &stream) const override;
+    void restore(std::istream &stream) override;
+    Site &getStart() const;
 private:
-    const std::shared_ptr<Site> &next() const;
+    Site &next() const;
+    /**
+     * Check if the bomber stands where update sends it on to the next site.
+     * @return true if it is at the next site of its tour, an unvisited site or its start, false otherwise.
+     */
+    bool isAtStop() const;
+    void leaveTour();
     static const CommanderFactory factory;
     static constexpr double speed = 1000;
-    std::shared_ptr<Site> start;
-    std::set<std::shared_ptr<Site>> sites;
+    Handle<Site> start;
+    uint32_t leg;
+    std::shared_ptr<const SiteIndex::Tour> tour;
+    SiteIndex::Visited visited;
 };
 
 class Destroyer : public Spaceship {
@@ -93,9 +175,13 @@ public:
         Rocket(const Point &start, const Point &finish);
         ~Rocket() override = default;
         void print(std::ostream &stream) const override;
-        void update() override;
+    private:
+        /**
+         * Every rocket shares one interned name.
+         */
+        static Symbol symbol();
     };
-    Destroyer(const std::string &name, const std::string &agentName, const Point &location);
+    Destroyer(Model &world, Symbol name, Symbol agentName, const Point &location);
     ~Destroyer() override = default;
     void print(std::ostream &stream) const override;
     void printType(std::ostream &stream) const override;
@@ -104,26 +190,75 @@ public:
 private:
     static const AdmiralFactory factory;
     static constexpr double speed = 2000;
-    std::vector<Rocket> rockets;
 };
 
 class Falcon : public Spaceship {
 public:
-    Falcon(const std::string &name, const Point &location);
+    Falcon(Model &world, Symbol name, const Point &location);
     ~Falcon() override = default;
-    void attack(const std::shared_ptr<Spaceship> &spaceship) override;
+    void attack(Spaceship &spaceship) override;
+    void attack(const Wreck &wreck) override;
     void course(double angle, double speed) override;
-    void goTo(const std::shared_ptr<Site> &site) override;
+    void goTo(Site &site) override;
     void go(const Object::Point &point, double speed) override;
     void update() override;
+    bool isSteady() const override;
     void print(std::ostream &stream) const override;
     void printType(std::ostream &stream) const override;
+    void save(std::ostream &stream) const override;
+    void restore(std::istream &stream) override;
+    /**
+     * Get the shuttle the falcon attacks in the coming tick.
+     * @return The victim, nullptr if there is none.
+     */
+    Spaceship *getVictim() const;
+    /**
+     * Get the archived shuttle the falcon attacks in the coming tick.
+     * @return The wreck, nullptr if there is none.
+     */
+    Wreck *getWreck() const;
 private:
-    void interact(const std::shared_ptr<SpaceStation> &station) override;
-    void interact(const std::shared_ptr<FortressStar> &star) override;
+    void interact(SpaceStation &station) override;
+    void interact(FortressStar &star) override;
     static constexpr double startHealth = 5;
     static constexpr double startSpeed = 3000;
-    std::shared_ptr<Spaceship> victim;
+    Handle<Spaceship> victim;
+    /**
+     * The name of the victim when it was archived before the attack, the empty symbol otherwise. It fits in the tail padding.
+     */
+    Symbol wreck;
+};
+
+/**
+ * What is left of a dead spaceship once its world archives it: only the state its status prints.
+ * A dead spaceship that stands still never changes again, so the wreck prints exactly what the spaceship did.
+ */
+class Wreck {
+public:
+    explicit Wreck(const Spaceship &spaceship);
+    Symbol getSymbol() const;
+    Spaceship::Kind getKind() const;
+    Object::Point getLocation() const;
+    size_t getCrystals() const;
+    /**
+     * Be attacked like the dead shuttle it was: it cannot be hurt, and it loses its crystals to an attacker that comes close enough.
+     * @param attacker The falcon.
+     * @param world The world of the falcon.
+     */
+    void beAttacked(Spaceship &attacker, Model &world);
+    /**
+     * Print the status of the dead spaceship.
+     * @param stream The stream to print to.
+     * @param world The world holding the agent that drove it.
+     */
+    void print(std::ostream &stream, const Model &world) const;
+private:
+    static constexpr const char *types[] = {"Shuttle", "Bomber", "Destroyer", "Falcon"};
+    Symbol name;
+    Coordinate::Stored location;
+    Handle<Agent> agent;
+    uint8_t crystals;
+    Spaceship::Kind kind;
 };
 
 
@@ -0,0 +1,51 @@
+#ifndef HW03_SWEEPGRID_H
+#define HW03_SWEEPGRID_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * A broad-phase uniform grid over the paths objects sweep during one tick.
+ * Every target is binned by the box around its path grown by the contact radius,
+ * so a query only returns targets whose paths can come within that radius of the queried path.
+ * The cell is sized to the queried paths, so a query touches at most four cells.
+ * Targets whose box would cover too many cells are kept aside and returned by every query.
+ */
+class SweepGrid {
+public:
+    /**
+     * A straight path from (x, y) at the start of the tick to (toX, toY) at its end.
+     */
+    struct Sweep {
+        double x;
+        double y;
+        double toX;
+        double toY;
+    };
+    SweepGrid();
+    /**
+     * Bin targets for the coming queries.
+     * @param targets The paths of the targets.
+     * @param radius The contact radius.
+     * @param extent The longest side of any box that will be queried.
+     */
+    void build(const std::vector<Sweep> &targets, double radius, double extent);
+    /**
+     * Find the targets that may come within the radius of a path. Each target is returned once.
+     * @param sweep The path, its box no wider than the extent given to build.
+     * @param candidates Receives the indices of the candidate targets.
+     */
+    void query(const Sweep &sweep, std::vector<uint32_t> &candidates) const;
+private:
+    static constexpr int64_t maxCells = 64;
+    int64_t cellOf(double coordinate) const;
+    static uint64_t key(int64_t x, int64_t y);
+    double cell;
+    std::vector<std::pair<uint64_t, uint32_t>> cells;
+    std::vector<uint32_t> oversized;
+    mutable std::vector<uint32_t> stamps;
+    mutable uint32_t stamp;
+};
+
+#endif //HW03_SWEEPGRID_H
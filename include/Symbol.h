@@ -0,0 +1,63 @@
+#ifndef HW03_SYMBOL_H
+#define HW03_SYMBOL_H
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <optional>
+#include <string>
+
+/**
+ * A name interned in a process-wide table. Every distinct name is stored once,
+ * and symbols compare and hash as 4-byte integers. Interning is safe from any thread, and reading a name takes no lock.
+ * Names are interned where they enter the game, so the Model never compares strings to find an entity.
+ */
+class Symbol {
+public:
+    /**
+     * Constructs the symbol of the empty name.
+     */
+    Symbol();
+    /**
+     * Get the symbol of a name, interning it the first time it is seen.
+     * @param name The name.
+     * @return Its symbol.
+     */
+    static Symbol intern(const std::string &name);
+    /**
+     * Get the symbol of a name without interning it. Names that only look entities up go through here,
+     * so names that match nothing do not grow the table.
+     * @param name The name.
+     * @return Its symbol, nothing if it was never interned, in which case no entity has it.
+     */
+    static std::optional<Symbol> find(const std::string &name);
+    /**
+     * Get the number of distinct names interned so far.
+     * @return The number of names.
+     */
+    static size_t count();
+    const std::string &str() const;
+    uint32_t getId() const;
+    bool operator==(const Symbol &symbol) const {
+        return id == symbol.id;
+    }
+    bool operator!=(const Symbol &symbol) const {
+        return id != symbol.id;
+    }
+private:
+    explicit Symbol(uint32_t id);
+    uint32_t id;
+};
+
+std::ostream &operator<<(std::ostream &stream, const Symbol &symbol);
+
+namespace std {
+    template<>
+    struct hash<Symbol> {
+        size_t operator()(const Symbol &symbol) const {
+            return symbol.getId();
+        }
+    };
+}
+
+#endif //HW03_SYMBOL_H
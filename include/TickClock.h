@@ -0,0 +1,67 @@
+#ifndef HW03_TICKCLOCK_H
+#define HW03_TICKCLOCK_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+/**
+ * Paces a real-time loop with a fixed timestep. Elapsed time accumulates and every whole period of it is a tick due,
+ * so the world advances at the same rate however irregularly the loop wakes up. After a stall at most catchUp ticks
+ * are due at once, and the time beyond that is dropped and counted as skipped ticks, so a slow world falls behind
+ * the wall clock instead of spiralling further behind.
+ * It also keeps the last window durations of the ticks, counting those that overran their period, and the latencies
+ * from the arrival of a command to the end of the tick that applied it.
+ */
+class TickClock {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t window = 1024;
+    /**
+     * Constructs a clock started now.
+     * @param rate The ticks per second.
+     * @param catchUp The most ticks due at once.
+     * @throw std::invalid_argument if the rate is not positive or catchUp is 0.
+     */
+    TickClock(double rate, size_t catchUp);
+    /**
+     * Account the time passed since the last call and take the ticks due.
+     * @return The number of ticks to run now, at most catchUp.
+     */
+    size_t due();
+    /**
+     * Get when the next tick is due.
+     * @return The time point.
+     */
+    Clock::time_point next() const;
+    /**
+     * Record a tick that ran.
+     * @param duration How long applying the batch and updating the world took.
+     */
+    void recordTick(Clock::duration duration);
+    /**
+     * Record the latency of a command.
+     * @param latency The time from its arrival to the end of the tick that applied it.
+     */
+    void recordLatency(Clock::duration latency);
+    /**
+     * Print the rate, the overruns, the skipped ticks and the percentiles of the tick durations and the latencies.
+     * @param stream The stream to print to.
+     */
+    void print(std::ostream &stream) const;
+private:
+    enum Series {TICKS, LATENCIES, SERIES};
+    void record(Series series, Clock::duration duration);
+    Clock::duration period;
+    size_t catchUp;
+    Clock::time_point last;
+    Clock::duration accumulated;
+    size_t overruns;
+    size_t skipped;
+    std::array<std::vector<int64_t>, SERIES> samples;
+    std::array<size_t, SERIES> counts;
+};
+
+#endif //HW03_TICKCLOCK_H
@@ -11,6 +11,19 @@
 namespace Utilities {
     std::vector<std::string> split(const std::string &string, char separator = ' ');
     std::string getLine(std::istream &stream);
+    /**
+     * Write a double so that readExact gives back the very same value, followed by a space.
+     * @param stream The stream to write to.
+     * @param value The value.
+     */
+    void writeExact(std::ostream &stream, double value);
+    /**
+     * Read a double written by writeExact.
+     * @param stream The stream to read from.
+     * @return The value.
+     * @throw std::invalid_argument if the next word is not a number.
+     */
+    double readExact(std::istream &stream);
 }
 
 #endif //HW01_UTILITIES_HPP
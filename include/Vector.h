@@ -395,7 +395,7 @@ std::ostream &operator<<(std::ostream &stream, const Vector<Type, size> &vector)
     stream << "[";
     const char *space = "";
     for (const Type &t : vector) {
-        std::cout << space << t;
+        stream << space << t;
         space = ", ";
     }
     return stream << "]";
@@ -2,19 +2,22 @@
 #define HW03_VIEW_H
 
 #include <cstddef>
+#include <iosfwd>
 #include <map>
 #include <memory>
 #include <vector>
 #include "Object.h"
 
+class Model;
+
 class View {
 public:
-    explicit View(size_t size = defaultSize, double zoom = defaultZoom, double x = defaultX, double y = defaultY);
+    explicit View(const Model &model, size_t size = defaultSize, double zoom = defaultZoom, double x = defaultX, double y = defaultY);
     void setDefaultView();
     void setSize(size_t s);
     void setZoom(double z);
     void setOrigin(double x, double y);
-    void show();
+    void show(std::ostream &stream);
 private:
     static constexpr const char *space = ". ";
     static constexpr std::pair<size_t, size_t> sizeBounds = {6, 30};
@@ -23,6 +26,7 @@ private:
     static constexpr double defaultZoom = 2.0;
     static constexpr double defaultX = 0;
     static constexpr double defaultY = 0;
+    const Model &model;
     std::map<std::pair<size_t, size_t>, std::shared_ptr<Object>> map;
     std::vector<double> xAxis;
     std::vector<double> yAxis;
@@ -31,8 +35,8 @@ private:
     double x;
     double y;
     void addToMap(const std::shared_ptr<Object> &object);
-    void printXAxis();
-    void printYAxis(size_t line);
+    void printXAxis(std::ostream &stream);
+    void printYAxis(std::ostream &stream, size_t line);
     void makeMatrix();
     void makeXAxis();
     void makeYAxis();
@@ -1,10 +1,20 @@
 #include "Agent.h"
+#include "AgentRegistry.h"
 #include <iostream>
 
 const std::string &Agent::getName() const {
+    return name.str();
+}
+Symbol Agent::getSymbol() const {
     return name;
 }
-Agent::Agent(std::string name) : name(std::move(name)) {
+Handle<Agent> Agent::getHandle() const {
+    return handle;
+}
+void Agent::setHandle(const Handle<Agent> &h) {
+    handle = h;
+}
+Agent::Agent(Symbol name) : name(name), handle() {
 
 }
 Agent::~Agent() = default;
@@ -17,7 +27,7 @@ std::ostream &operator<<(std::ostream &stream, const Agent &agent) {
     return stream;
 }
 
-Shipman::Shipman(const std::string &name) : Agent(name) {
+Shipman::Shipman(Symbol name) : Agent(name) {
 
 }
 Shipman::~Shipman() = default;
@@ -25,7 +35,7 @@ void Shipman::printType(std::ostream &stream) const {
     stream << "Midshipman";
 }
 
-Commander::Commander(const std::string &name) : Agent(name) {
+Commander::Commander(Symbol name) : Agent(name) {
 
 }
 Commander::~Commander() = default;
@@ -33,7 +43,7 @@ void Commander::printType(std::ostream &stream) const {
     stream << "Commander";
 }
 
-Admiral::Admiral(const std::string &name) : Agent(name) {
+Admiral::Admiral(Symbol name) : Agent(name) {
 
 }
 Admiral::~Admiral() = default;
@@ -43,17 +53,17 @@ void Admiral::printType(std::ostream &stream) const {
 
 AgentFactory::~AgentFactory() = default;
 
-std::shared_ptr<Agent> ShipmanFactory::create(const std::string &name) const {
-    return std::make_shared<Shipman>(name);
+Handle<Agent> ShipmanFactory::create(Symbol name, AgentRegistry &registry) const {
+    return registry.create<Shipman>(name);
 }
 ShipmanFactory::~ShipmanFactory() = default;
 
-std::shared_ptr<Agent> CommanderFactory::create(const std::string &name) const {
-    return std::make_shared<Commander>(name);
+Handle<Agent> CommanderFactory::create(Symbol name, AgentRegistry &registry) const {
+    return registry.create<Commander>(name);
 }
 CommanderFactory::~CommanderFactory() = default;
 
-std::shared_ptr<Agent> AdmiralFactory::create(const std::string &name) const {
-    return std::make_shared<Admiral>(name);
+Handle<Agent> AdmiralFactory::create(Symbol name, AgentRegistry &registry) const {
+    return registry.create<Admiral>(name);
 }
 AdmiralFactory::~AdmiralFactory() = default;
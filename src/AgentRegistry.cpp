@@ -0,0 +1,66 @@
+#include "AgentRegistry.h"
+#include <algorithm>
+#include <stdexcept>
+
+AgentRegistry::AgentRegistry() :
+    shipmen(),
+    commanders(),
+    admirals(),
+    slots(),
+    names(),
+    assigned(),
+    order(),
+    dirty(false)
+{
+
+}
+
+Agent *AgentRegistry::find(Symbol name) const {
+    auto iterator = names.find(name);
+    if (iterator == names.end()) return nullptr;
+    return slots.resolve(iterator->second);
+}
+
+Agent *AgentRegistry::resolve(const Handle<Agent> &handle) const {
+    return slots.resolve(handle);
+}
+
+bool AgentRegistry::isAssigned(const Handle<Agent> &handle) const {
+    if (resolve(handle) == nullptr) return false;
+    uint32_t index = handle.getIndex();
+    return (assigned[index / 64] >> (index % 64)) & 1;
+}
+
+void AgentRegistry::take(const Handle<Agent> &handle) {
+    if (resolve(handle) == nullptr || isAssigned(handle)) throw std::out_of_range("The agent is already assigned");
+    uint32_t index = handle.getIndex();
+    assigned[index / 64] |= (uint64_t)1 << (index % 64);
+}
+
+void AgentRegistry::release(const Handle<Agent> &handle) {
+    if (resolve(handle) == nullptr) return;
+    uint32_t index = handle.getIndex();
+    assigned[index / 64] &= ~((uint64_t)1 << (index % 64));
+}
+
+std::vector<const Agent *> AgentRegistry::unassigned() const {
+    if (dirty) {
+        order.clear();
+        for (const auto &agent: shipmen) order.push_back(&agent);
+        for (const auto &agent: commanders) order.push_back(&agent);
+        for (const auto &agent: admirals) order.push_back(&agent);
+        std::sort(order.begin(), order.end(), [](const Agent *a, const Agent *b) -> bool {
+            return a->getName() < b->getName();
+        });
+        dirty = false;
+    }
+    std::vector<const Agent *> result;
+    for (const Agent *agent: order) {
+        if (!isAssigned(agent->getHandle())) result.push_back(agent);
+    }
+    return result;
+}
+
+size_t AgentRegistry::size() const {
+    return slots.size();
+}
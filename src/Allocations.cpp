@@ -0,0 +1,82 @@
+#include "Allocations.h"
+#include <algorithm>
+#include <mutex>
+#include <ostream>
+
+namespace {
+    struct Totals {
+        size_t allocations;
+        size_t bytes;
+        size_t scopes;
+        size_t mostAllocations;
+        size_t mostBytes;
+    };
+
+    /**
+     * Updating the totals allocates nothing, so operator new can take the lock.
+     */
+    struct Accounts {
+        std::mutex mutex;
+        Totals totals[Allocations::SUBSYSTEMS];
+    };
+
+    Accounts &accounts() {
+        static Accounts accounts;
+        return accounts;
+    }
+}
+
+void Allocations::setEnabled(bool on) {
+    if constexpr (compiled) enabled.store(on, std::memory_order_relaxed);
+}
+
+void Allocations::reset() {
+    Accounts &all = accounts();
+    std::lock_guard<std::mutex> lock(all.mutex);
+    std::fill(std::begin(all.totals), std::end(all.totals), Totals{0, 0, 0, 0, 0});
+}
+
+void Allocations::record(Allocations::Subsystem subsystem, size_t size) {
+    Accounts &all = accounts();
+    std::lock_guard<std::mutex> lock(all.mutex);
+    ++all.totals[subsystem].allocations;
+    all.totals[subsystem].bytes += size;
+}
+
+void Allocations::close(Allocations::Subsystem subsystem, size_t allocations, size_t bytes) {
+    if (!isEnabled()) return;
+    Accounts &all = accounts();
+    std::lock_guard<std::mutex> lock(all.mutex);
+    Totals &totals = all.totals[subsystem];
+    totals.allocations += allocations;
+    totals.bytes += bytes;
+    ++totals.scopes;
+    totals.mostAllocations = std::max(totals.mostAllocations, allocations);
+    totals.mostBytes = std::max(totals.mostBytes, bytes);
+}
+
+void Allocations::print(std::ostream &stream) {
+    if (!compiled) {
+        stream << "Allocation counting was compiled out with DISABLE_ALLOCATIONS." << std::endl;
+        return;
+    }
+    Totals totals[SUBSYSTEMS];
+    {
+        Accounts &all = accounts();
+        std::lock_guard<std::mutex> lock(all.mutex);
+        std::copy(std::begin(all.totals), std::end(all.totals), std::begin(totals));
+    }
+    stream << "Allocation counting is " << (isEnabled() ? "on." : "off.") << std::endl;
+    for (size_t subsystem = 0; subsystem < SUBSYSTEMS; ++subsystem) {
+        const Totals &total = totals[subsystem];
+        if (total.allocations == 0 && total.scopes == 0) continue;
+        stream << names[subsystem] << ": " << total.allocations << " allocations, " << total.bytes << " bytes";
+        if (total.scopes != 0) {
+            stream << " over " << total.scopes << (subsystem == TICK ? " ticks" : " commands") << ", "
+                   << (double)total.allocations / (double)total.scopes << " allocations and "
+                   << (double)total.bytes / (double)total.scopes << " bytes on average, at most "
+                   << total.mostAllocations << " allocations and " << total.mostBytes << " bytes";
+        }
+        stream << "." << std::endl;
+    }
+}
@@ -0,0 +1,48 @@
+#include "Archive.h"
+
+Archive::Archive(double cell) : wrecks(), kinds(), ids(), grid(cell) {
+
+}
+
+void Archive::add(const Spaceship &spaceship) {
+    auto inserted = wrecks.emplace(spaceship.getSymbol(), Wreck(spaceship));
+    if (!inserted.second) return;
+    const Wreck *wreck = &inserted.first->second;
+    kinds[wreck->getKind()].push_back(wreck);
+    grid.insert((uint32_t)ids.size(), wreck->getLocation());
+    ids.push_back(wreck);
+}
+
+const Wreck *Archive::find(Symbol name) const {
+    auto iterator = wrecks.find(name);
+    return iterator != wrecks.end() ? &iterator->second : nullptr;
+}
+
+Wreck *Archive::find(Symbol name) {
+    auto iterator = wrecks.find(name);
+    return iterator != wrecks.end() ? &iterator->second : nullptr;
+}
+
+size_t Archive::size() const {
+    return wrecks.size();
+}
+
+Archive::Wrecks::const_iterator Archive::begin() const {
+    return wrecks.begin();
+}
+
+Archive::Wrecks::const_iterator Archive::end() const {
+    return wrecks.end();
+}
+
+const std::vector<const Wreck *> &Archive::ofKind(Spaceship::Kind kind) const {
+    return kinds[kind];
+}
+
+void Archive::within(const Object::Point &center, double radius, std::vector<const Wreck *> &found) const {
+    std::vector<uint32_t> matches;
+    grid.within(center, radius, matches);
+    for (uint32_t id: matches) {
+        found.push_back(ids[id]);
+    }
+}
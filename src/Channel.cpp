@@ -0,0 +1,88 @@
+#include "Channel.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+std::pair<Channel, Channel> Channel::pair() {
+    int descriptors[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, descriptors) != 0) {
+        throw std::runtime_error(std::string("Could not create a socket pair: ") + std::strerror(errno) + ".");
+    }
+    return {Channel(descriptors[0]), Channel(descriptors[1])};
+}
+
+Channel::Channel(int descriptor) : descriptor(descriptor) {
+
+}
+
+Channel::~Channel() {
+    close();
+}
+
+Channel::Channel(Channel &&channel) noexcept : descriptor(channel.descriptor) {
+    channel.descriptor = -1;
+}
+
+Channel &Channel::operator=(Channel &&channel) noexcept {
+    if (this != &channel) {
+        close();
+        descriptor = channel.descriptor;
+        channel.descriptor = -1;
+    }
+    return *this;
+}
+
+void Channel::send(const std::vector<std::string> &fields) {
+    std::string message;
+    auto append = [&message](uint64_t size) -> void {
+        message.append(reinterpret_cast<const char *>(&size), sizeof(size));
+    };
+    append(fields.size());
+    for (const std::string &field: fields) {
+        append(field.size());
+        message += field;
+    }
+    write(message.data(), message.size());
+}
+
+std::vector<std::string> Channel::receive() {
+    uint64_t count;
+    read(reinterpret_cast<char *>(&count), sizeof(count));
+    std::vector<std::string> fields(count);
+    for (std::string &field: fields) {
+        uint64_t size;
+        read(reinterpret_cast<char *>(&size), sizeof(size));
+        field.resize(size);
+        read(field.data(), size);
+    }
+    return fields;
+}
+
+void Channel::close() {
+    if (descriptor < 0) return;
+    ::close(descriptor);
+    descriptor = -1;
+}
+
+void Channel::write(const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::send(descriptor, data, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) throw std::runtime_error("The channel was closed.");
+        data += written;
+        size -= (size_t)written;
+    }
+}
+
+void Channel::read(char *data, size_t size) {
+    while (size > 0) {
+        ssize_t count = ::recv(descriptor, data, size, 0);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) throw std::runtime_error("The channel was closed.");
+        data += count;
+        size -= (size_t)count;
+    }
+}
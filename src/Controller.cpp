@@ -1,62 +1,180 @@
 #include "Controller.h"
 #include <fstream>
+#include <optional>
+#include <sstream>
+#include "Allocations.h"
 #include "Model.h"
+#include "Query.h"
+#include "Server.h"
+#include "Tracer.h"
 
-Controller::Controller() : view(), time(0) {
-    Model &model = Model::get();
+Controller::Controller(std::istream &inputStream, std::ostream &outputStream, std::ostream &errorStream) :
+    input(inputStream),
+    output(outputStream),
+    errors(errorStream),
+    model(),
+    shards(),
+    view(model),
+    time(0),
+    traceFile()
+{
+    Model &model = this->model;
     creatorCommand = {
         {"shuttle", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() != 6) throw std::invalid_argument("Usage: create shuttle <name> <agent_name> (<x>, <y>)");
-            model.createShuttle(args[2], args[3], Controller::parseXY(args[4]), Controller::parseXY(args[5]));
+            model.createShuttle(Symbol::intern(args[2]), Symbol::intern(args[3]), Controller::parseXY(args[4]), Controller::parseXY(args[5]));
         }},
         {"bomber", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() != 5) throw std::invalid_argument("Usage: create bomber <name> <agent_name> <site_name>");
-            model.createBomber(args[2], args[3], args[4]);
+            model.createBomber(Symbol::intern(args[2]), Symbol::intern(args[3]), Symbol::intern(args[4]));
         }},
         {"destroyer", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() != 6) throw std::invalid_argument("Usage: create destroyer <name> <agent_name> (<x>, <y>)");
-            model.createDestroyer(args[2], args[3], Controller::parseXY(args[4]), Controller::parseXY(args[5]));
+            model.createDestroyer(Symbol::intern(args[2]), Symbol::intern(args[3]), Controller::parseXY(args[4]), Controller::parseXY(args[5]));
         }},
         {"falcon", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() != 5) throw std::invalid_argument("Usage: create falcon <name> (<x>, <y>)");
-            model.createFalcon(args[2], Controller::parseXY(args[3]), Controller::parseXY(args[4]));
+            model.createFalcon(Symbol::intern(args[2]), Controller::parseXY(args[3]), Controller::parseXY(args[4]));
         }},
         {"midshipman", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() != 3) throw std::invalid_argument("Usage: create midshipman <name>");
-            model.createShipman(args[2]);
+            model.createShipman(Symbol::intern(args[2]));
         }},
         {"commander", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() != 3) throw std::invalid_argument("Usage: create commander <name>");
-            model.createCommander(args[2]);
+            model.createCommander(Symbol::intern(args[2]));
         }},
         {"admiral", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() != 3) throw std::invalid_argument("Usage: create admiral <name>");
-            model.createAdmiral(args[2]);
+            model.createAdmiral(Symbol::intern(args[2]));
         }},
     };
     modelViewCommands = {
-        {"status", [&model](const std::vector<std::string> &args) -> void {
+        {"status", [this, &model](const std::vector<std::string> &args) -> void {
             if (args.size() != 1) throw std::invalid_argument("Usage: status");
+            if (shards != nullptr) {
+                shards->status(output);
+                return;
+            }
+            auto wreck = model.getWrecks().begin();
             for (const auto &spaceship: model.getSpaceships()) {
-                std::cout << *spaceship << std::endl;
+                for (; wreck != model.getWrecks().end() && wreck->first.str() < spaceship->getName(); ++wreck) {
+                    wreck->second.print(output, model);
+                    output << std::endl;
+                }
+                output << *spaceship << std::endl;
+            }
+            for (; wreck != model.getWrecks().end(); ++wreck) {
+                wreck->second.print(output, model);
+                output << std::endl;
             }
             for (const auto &site: model.getSites()) {
-                std::cout << *site << std::endl;
+                output << *site << std::endl;
             }
             for (const auto &agent: model.getAgents()) {
-                std::cout << *agent << std::endl;
+                output << *agent << std::endl;
             }
             for (const auto &rocket: model.getRockets()) {
-                std::cout << rocket << std::endl;
+                output << *rocket << std::endl;
             }
         }},
+        {"query", [this, &model](const std::vector<std::string> &args) -> void {
+            Query query(args, model);
+            if (shards != nullptr) {
+                shards->query(query, args, output);
+            } else {
+                query.print(query.match(model, output), output);
+            }
+        }},
+        {"economy", [this, &model](const std::vector<std::string> &args) -> void {
+            if (args.size() != 1) throw std::invalid_argument("Usage: economy");
+            Model::Economy economy = shards != nullptr ? shards->economy() : model.getEconomy();
+            output << "Crystals produced: " << economy.produced << ", delivered: " << economy.delivered << ", stolen: " << economy.stolen << "." << std::endl;
+        }},
+        {"stats", [this, &model](const std::vector<std::string> &args) -> void {
+            if (args.size() != 1) throw std::invalid_argument("Usage: stats");
+            size_t kinds[4] = {0, 0, 0, 0};
+            std::ostringstream profiles;
+            profiles.copyfmt(output);
+            if (shards != nullptr) {
+                shards->stats(kinds, profiles);
+            } else {
+                for (const auto &spaceship: model.getSpaceships()) {
+                    ++kinds[spaceship->getKind()];
+                }
+                for (const auto &wreck: model.getWrecks()) {
+                    ++kinds[wreck.second.getKind()];
+                }
+                model.getProfiler().print(profiles);
+            }
+            output << "Shuttles: " << kinds[Spaceship::SHUTTLE] << ", bombers: " << kinds[Spaceship::BOMBER]
+                      << ", destroyers: " << kinds[Spaceship::DESTROYER] << ", falcons: " << kinds[Spaceship::FALCON]
+                      << ", sites: " << model.getSites().size() << ", free agents: " << model.getAgents().size()
+                      << ", rockets: " << model.getRockets().size() << "." << std::endl;
+            output << profiles.str();
+        }},
+        {"mem", [this](const std::vector<std::string> &args) -> void {
+            if (args.size() == 1) {
+                Allocations::print(output);
+            } else if (args.size() == 2 && (args[1] == "on" || args[1] == "off")) {
+                if (!Allocations::compiled) throw std::runtime_error("Allocation counting was compiled out with DISABLE_ALLOCATIONS.");
+                Allocations::setEnabled(args[1] == "on");
+            } else if (args.size() == 2 && args[1] == "reset") {
+                Allocations::reset();
+            } else {
+                throw std::invalid_argument("Usage: mem [on|off|reset]");
+            }
+        }},
+        {"trace", [this](const std::vector<std::string> &args) -> void {
+            if (args.size() == 2 && (args[1] == "on" || args[1] == "off")) {
+                if (!Tracer::compiled) throw std::runtime_error("The tracer was compiled out with DISABLE_TRACER.");
+                Tracer::setEnabled(args[1] == "on");
+            } else if (args.size() == 3 && args[1] == "on") {
+                if (!Tracer::compiled) throw std::runtime_error("The tracer was compiled out with DISABLE_TRACER.");
+                Tracer::setEnabled(true);
+                traceFile = args[2];
+            } else if (args.size() == 3 && args[1] == "dump") {
+                dumpTrace(args[2]);
+            } else {
+                throw std::invalid_argument("Usage: trace <on|off> | trace on <file written at exit> | trace dump <file>");
+            }
+        }},
+        {"dispatch", [this, &model](const std::vector<std::string> &args) -> void {
+            if (args.size() != 2 || (args[1] != "on" && args[1] != "off")) throw std::invalid_argument("Usage: dispatch <on|off>");
+            if (shards != nullptr && args[1] == "on") throw std::runtime_error("The dispatcher does not run on a sharded world.");
+            model.getDispatcher().setEnabled(args[1] == "on");
+        }},
+        {"reserve", [this, &model](const std::vector<std::string> &args) -> void {
+            static const std::map<std::string, Model::Pooled> types = {
+                {"shuttle", Model::SHUTTLES}, {"bomber", Model::BOMBERS}, {"destroyer", Model::DESTROYERS}, {"falcon", Model::FALCONS},
+                {"station", Model::STATIONS}, {"fortress", Model::STARS}, {"rocket", Model::ROCKETS},
+            };
+            if (args.size() != 3 || types.find(args[1]) == types.end()) {
+                throw std::invalid_argument("Usage: reserve <shuttle|bomber|destroyer|falcon|station|fortress|rocket> <count>");
+            }
+            model.reserve(types.at(args[1]), std::stoull(args[2]));
+            if (shards != nullptr) shards->broadcast(args, output);
+        }},
+        {"blast", [&model](const std::vector<std::string> &args) -> void {
+            if (args.size() != 2) throw std::invalid_argument("Usage: blast <radius>");
+            model.setBlastRadius(parseXY(args[1]));
+        }},
         {"go", [this, &model](const std::vector<std::string> &args) -> void {
             if (args.size() != 1) throw std::invalid_argument("Usage: go");
-            model.update();
+            if (shards != nullptr) {
+                shards->update();
+            } else {
+                model.update();
+            }
             ++time;
         }},
         {"create", [this](const std::vector<std::string> &args) -> void {
             if (args.size() < 2) throw std::invalid_argument("Usage: create <type> <args...>");
+            Allocations::Scope scope(Allocations::CREATION);
+            if (shards != nullptr && Shards::creates(args[1])) {
+                shards->create(args, output);
+                return;
+            }
             creatorCommand.at(args[1])(args);
         }},
         {"default", [this](const std::vector<std::string> &args) -> void {
@@ -77,66 +195,105 @@ Controller::Controller() : view(), time(0) {
         }},
         {"show", [this](const std::vector<std::string> &args) -> void {
             if (args.size() != 1) throw std::invalid_argument("Usage: show");
-            view.show();
+            if (shards != nullptr) throw std::runtime_error("The map cannot be shown of a sharded world.");
+            Allocations::Scope scope(Allocations::VIEW);
+            view.show(output);
         }},
     };
     spaceshipCommands = {
         {"course", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() == 3) {
-                model.course(args[0], parseSpeed(args[2]));
+                model.course(find(args[0], "a spaceship"), parseSpeed(args[2]));
             } else if (args.size() == 4) {
-                model.course(args[0], std::stod(args[2]), parseSpeed(args[3]));
+                model.course(find(args[0], "a spaceship"), std::stod(args[2]), parseSpeed(args[3]));
             } else {
                 throw std::invalid_argument("Usage: <spaceship_name> course <angle> [speed]");
             }
         }},
         {"position", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() == 4) {
-                model.position(args[0], parseXY(args[2]), parseXY(args[3]));
+                model.position(find(args[0], "a spaceship"), parseXY(args[2]), parseXY(args[3]));
             } else if (args.size() == 5) {
-                model.position(args[0], parseXY(args[2]), parseXY(args[3]), parseSpeed(args[4]));
+                model.position(find(args[0], "a spaceship"), parseXY(args[2]), parseXY(args[3]), parseSpeed(args[4]));
             }
             if (args.size() != 4) throw std::invalid_argument("Usage: <spaceship_name> position (<x>, <y>) [speed]");
         }},
         {"destination", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() != 3) throw std::invalid_argument("Usage: <spaceship_name> destination <site_name>");
-            model.destination(args[0], args[2]);
+            model.destination(find(args[0], "a spaceship"), find(args[2], "a site"));
         }},
         {"stop", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() != 2) throw std::invalid_argument("Usage: <spaceship_name> stop");
-            model.stop(args[0]);
+            model.stop(find(args[0], "a spaceship"));
         }},
         {"attack", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() != 3) throw std::invalid_argument("Usage: <falcon_name> attack <shuttle_name>");
-            model.attack(args[0], args[2]);
+            model.attack(find(args[0], "a spaceship"), find(args[2], "a spaceship"));
         }},
         {"shoot", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() != 4) throw std::invalid_argument("Usage: <destroy_name> shoot (<x>, <y>)");
-            model.shoot(args[0], Controller::parseXY(args[2]), Controller::parseXY(args[3]));
+            model.shoot(find(args[0], "a spaceship"), Controller::parseXY(args[2]), Controller::parseXY(args[3]));
         }},
         {"start_supply", [&model](const std::vector<std::string> &args) -> void {
             if (args.size() != 4) throw std::invalid_argument("Usage: <shuttle_name> transport <space_station_name> <fortress_star_name>");
-            model.transport(args[0], args[2], args[3]);
+            Symbol station = find(args[2], "a site");
+            model.transport(find(args[0], "a spaceship"), station, find(args[3], "a site"));
         }},
-        {"status", [&model](const std::vector<std::string> &args) -> void {
+        {"status", [this, &model](const std::vector<std::string> &args) -> void {
             if (args.size() != 2) throw std::invalid_argument("Usage: <spaceship_name> status");
-            std::cout << *model.findSpaceship(args[0]) << std::endl;
+            output << model.findSpaceship(find(args[0], "a spaceship")) << std::endl;
         }},
     };
 }
+Controller::~Controller() = default;
 void Controller::run(int argc, char **argv) {
+    // Without --serve and --rate the console advances the time with go, with either the world ticks by itself.
+    std::map<std::string, std::string> options = {{"--shards", "1"}, {"--serve", ""}, {"--rate", ""}, {"--catch-up", "5"}};
+    size_t count = 0;
+    double rate = 0;
+    size_t catchUp = 0;
     try {
-        if (argc != 2) throw std::invalid_argument("Usage: <binary_file> <sites_file>");
-        open(argv[1]);
+        for (int i = 2; i + 1 < argc && argc % 2 == 0; i += 2) {
+            options.at(argv[i]) = argv[i + 1];
+        }
+        count = std::stoull(options["--shards"]);
+        rate = std::stod(options["--rate"].empty() ? "10" : options["--rate"]);
+        catchUp = std::stoull(options["--catch-up"]);
     } catch (const std::exception &exception) {
-        std::cerr << exception.what() << std::endl;
+        count = 0;
+    }
+    if (argc < 2 || argc % 2 != 0 || count == 0 || !(rate > 0) || catchUp == 0) {
+        errors << "Usage: <binary_file> <sites_file> [--shards <count>] [--serve <socket_path|port>] [--rate <ticks_per_second> [--catch-up <ticks>]]" << std::endl;
+        return;
+    }
+    if (!options["--serve"].empty() || !options["--rate"].empty()) {
+        Server server(options["--serve"], rate, catchUp, output);
+        server.run(argv[1], count);
         return;
     }
+    run(argv[1], count);
+}
+bool Controller::run(const std::string &path, size_t count) {
+    try {
+        open(path, count);
+    } catch (const std::exception &exception) {
+        errors << exception.what() << std::endl;
+        return false;
+    }
     run();
+    shards = nullptr;
+    return true;
+}
+Model &Controller::getModel() {
+    return model;
+}
+size_t Controller::getTime() const {
+    return time;
 }
-void Controller::open(const std::string &path) {
+void Controller::open(const std::string &path, size_t count) {
     std::ifstream file = std::ifstream(path);
     if (!file) throw std::invalid_argument("Could not open file: " + path + ".");
+    Allocations::Scope scope(Allocations::CREATION);
     size_t lineNumber = 0;
     while (file) {
         ++lineNumber;
@@ -155,7 +312,7 @@ void Controller::open(const std::string &path) {
                 throw std::invalid_argument("Number of crystals has to be a non negative integer.");
             }
             if (args.size() == 5 && args[0] == "fortress") {
-                Model::get().createFortressStar(name, x, y, crystals);
+                model.createFortressStar(Symbol::intern(name), x, y, crystals);
                 continue;
             } else if (args.size() == 6 && args[0] == "station") {
                 size_t rate;
@@ -164,12 +321,18 @@ void Controller::open(const std::string &path) {
                 } catch (const std::invalid_argument &exception) {
                     throw std::invalid_argument("Crystal production rate has to be a non negative integer.");
                 }
-                Model::get().createSpaceStation(name, x, y, crystals, rate);
+                model.createSpaceStation(Symbol::intern(name), x, y, crystals, rate);
                 continue;
             }
         }
         throw std::invalid_argument("Failed to parse line " + std::to_string(lineNumber) + ".");
     }
+    if (count > 1) shards = std::make_unique<Shards>(model, path, count);
+}
+void Controller::dumpTrace(const std::string &path) {
+    std::ofstream file(path);
+    if (!file) throw std::invalid_argument("Could not open file: " + path + ".");
+    output << "Wrote " << Tracer::dump(file) << " trace events to " << path << "." << std::endl;
 }
 double Controller::parseXY(const std::string &arg) {
     try {
@@ -196,38 +359,47 @@ void Controller::sanitize(std::string &line) {
     }
     std::replace(line.begin(), line.end(), ',', ' ');
 }
+Symbol Controller::find(const std::string &name, const std::string &kind) {
+    std::optional<Symbol> symbol = Symbol::find(name);
+    if (!symbol) throw std::out_of_range("Did not find " + kind + " named " + name + ".");
+    return *symbol;
+}
 void Controller::run() {
     while (true) {
-        try {
-            std::cout << "Time " + std::to_string(time) + ": ";
-            std::string command = Utilities::getLine(std::cin);
-            sanitize(command);
-            std::vector<std::string> args = Utilities::split(command);
-            if (args.empty()) continue;
-            if (args[0] == "exit") return;
-            if (modelViewCommands.find(args[0]) != modelViewCommands.end()) {
-                Commands::mapped_type function;
-                try {
-                    function = modelViewCommands.at(args[0]);
-                } catch (const std::out_of_range &exception) {
-                    throw std::out_of_range("Could not find the command " + args[0]);
-                }
-                function(args);
-            } else if (args.size() > 1 && spaceshipCommands.find(args[1]) != spaceshipCommands.end()) {
-                std::shared_ptr<Spaceship> spaceship = Model::get().findSpaceship(args[0]);
-                if (spaceship->status() == Spaceship::DEAD) throw std::runtime_error(spaceship->getName() + " is dead and cannot operate.");
-                Commands::mapped_type function;
-                try {
-                    function = spaceshipCommands.at(args[1]);
-                } catch (const std::out_of_range &exception) {
-                    throw std::out_of_range("Could not find the command " + args[1]);
-                }
-                function(args);
-            } else {
-                throw std::invalid_argument("Failed to parse the input. Please check it and try again.");
+        Allocations::Scope scope(Allocations::CONTROLLER);
+        output << "Time " + std::to_string(time) + ": ";
+        if (!execute(Utilities::getLine(input))) return;
+    }
+}
+bool Controller::execute(std::string line) {
+    try {
+        sanitize(line);
+        std::vector<std::string> args = Utilities::split(line);
+        if (args.empty() && !input) args = {"exit"};
+        if (args.empty()) return true;
+        if (args[0] == "exit") {
+            if (!traceFile.empty()) dumpTrace(traceFile);
+            return false;
+        }
+        auto handler = modelViewCommands.find(args[0]);
+        if (handler != modelViewCommands.end()) {
+            Tracer::Span span(handler->first.c_str(), "command");
+            handler->second(args);
+        } else if (args.size() > 1 && (handler = spaceshipCommands.find(args[1])) != spaceshipCommands.end()) {
+            if (shards != nullptr) {
+                Tracer::Span span(handler->first.c_str(), "command", find(args[0], "a spaceship"));
+                shards->command(args, output);
+                return true;
             }
-        } catch (const std::exception &exception) {
-            std::cerr << exception.what() << std::endl;
+            Spaceship &spaceship = model.findSpaceship(find(args[0], "a spaceship"));
+            if (spaceship.status() == Spaceship::DEAD) throw std::runtime_error(spaceship.getName() + " is dead and cannot operate.");
+            Tracer::Span span(handler->first.c_str(), "command", spaceship.getSymbol());
+            handler->second(args);
+        } else {
+            throw std::invalid_argument("Failed to parse the input. Please check it and try again.");
         }
+    } catch (const std::exception &exception) {
+        errors << exception.what() << std::endl;
     }
+    return true;
 }
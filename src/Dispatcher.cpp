@@ -0,0 +1,106 @@
+#include "Dispatcher.h"
+#include <algorithm>
+#include <cmath>
+#include "Geometry.h"
+#include "Model.h"
+
+Dispatcher::Dispatcher() :
+    assignments(),
+    reserved(),
+    stars(),
+    starDistances(),
+    others(),
+    sites(0),
+    cursor(),
+    enabled(false)
+{
+
+}
+
+void Dispatcher::setEnabled(bool e) {
+    enabled = e;
+    if (enabled) return;
+    assignments.clear();
+    std::fill(reserved.begin(), reserved.end(), 0);
+}
+
+bool Dispatcher::isEnabled() const {
+    return enabled;
+}
+
+void Dispatcher::dispatch(const Model &model) {
+    if (!enabled) return;
+    const SiteIndex &index = model.getSiteIndex();
+    if (index.size() != sites) refresh(index);
+    for (Shuttle *shuttle: model.getIdleShuttles(cursor, budget)) {
+        assign(index, *shuttle);
+    }
+}
+
+void Dispatcher::release(const Handle<Spaceship> &shuttle) {
+    auto iterator = assignments.find(shuttle.getIndex());
+    if (iterator == assignments.end() || iterator->second.shuttle != shuttle) return;
+    reserved[iterator->second.station] -= iterator->second.crystals;
+    assignments.erase(iterator);
+}
+
+void Dispatcher::refresh(const SiteIndex &index) {
+    sites = index.size();
+    reserved.resize(sites, 0);
+    stars.assign(sites, sites);
+    starDistances.assign(sites, 0);
+    others = SiteIndex::Visited(sites);
+    std::vector<size_t> fortresses;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    for (size_t id = 0; id < sites; ++id) {
+        if (std::dynamic_pointer_cast<SpaceStation>(index.get(id)) != nullptr) continue;
+        others.insert(id);
+        if (std::dynamic_pointer_cast<FortressStar>(index.get(id)) == nullptr) continue;
+        fortresses.push_back(id);
+        xs.push_back(index.get(id)->getLocation()[0]);
+        ys.push_back(index.get(id)->getLocation()[1]);
+    }
+    if (fortresses.empty()) return;
+    for (size_t id = 0; id < sites; ++id) {
+        if (others.contains(id)) continue;
+        Object::Point location = index.get(id)->getLocation();
+        size_t closest = Geometry::nearest(xs.data(), ys.data(), fortresses.size(), location[0], location[1]);
+        if (closest == fortresses.size()) continue;
+        stars[id] = fortresses[closest];
+        starDistances[id] = location.distance(index.get(stars[id])->getLocation());
+    }
+}
+
+void Dispatcher::assign(const SiteIndex &index, Shuttle &shuttle) {
+    Object::Point location = shuttle.getLocation();
+    double speed = shuttle.getSpeed();
+    size_t capacity = shuttle.crystalsToTake();
+    if (speed <= 0) return;
+    double bestScore = 0;
+    size_t bestStation = sites;
+    size_t bestCrystals = 0;
+    for (size_t id: index.nearest(location, candidates, others)) {
+        if (stars[id] == sites) continue;
+        // A full shuttle takes nothing at a station, but the job brings its crystals on to the star of the nearest one.
+        if (capacity == 0) {
+            bestStation = id;
+            break;
+        }
+        auto *station = static_cast<SpaceStation *>(index.get(id).get());
+        double toStation = std::ceil(location.distance(station->getLocation()) / speed);
+        double toStar = std::ceil(starDistances[id] / speed);
+        double expected = (double)station->getCrystals() + (double)station->getProductionRate() * toStation - (double)reserved[id];
+        size_t crystals = (size_t)std::min((double)capacity, std::max(0.0, expected));
+        double score = (double)crystals / (toStation + toStar + 1);
+        if (score > bestScore) {
+            bestScore = score;
+            bestStation = id;
+            bestCrystals = crystals;
+        }
+    }
+    if (bestStation == sites) return;
+    shuttle.transport(static_cast<SpaceStation &>(*index.get(bestStation)), static_cast<FortressStar &>(*index.get(stars[bestStation])));
+    reserved[bestStation] += bestCrystals;
+    assignments[shuttle.getHandle().getIndex()] = {shuttle.getHandle(), bestStation, bestCrystals};
+}
@@ -0,0 +1,63 @@
+#include "EntityPool.h"
+#include <algorithm>
+#include <cstddef>
+
+EntityPool::EntityPool() : chunks(), free(nullptr), block(0), used(0), total(0), reserved(0) {
+
+}
+
+void EntityPool::reserve(size_t count) {
+    reserved = std::max(reserved, count);
+    if (block != 0 && total < count) grow(count - total);
+}
+
+size_t EntityPool::size() const {
+    return used;
+}
+
+size_t EntityPool::capacity() const {
+    return total;
+}
+
+void *EntityPool::do_allocate(size_t bytes, size_t alignment) {
+    if (block == 0 && alignment <= alignof(std::max_align_t)) {
+        block = (std::max(bytes, sizeof(void *)) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+    }
+    if (!pooled(bytes, alignment)) {
+        return std::pmr::get_default_resource()->allocate(bytes, alignment);
+    }
+    if (free == nullptr) grow(std::max({firstChunk, total, reserved - std::min(reserved, total)}));
+    void *pointer = free;
+    free = *static_cast<void **>(free);
+    ++used;
+    return pointer;
+}
+
+void EntityPool::do_deallocate(void *pointer, size_t bytes, size_t alignment) {
+    if (!pooled(bytes, alignment)) {
+        std::pmr::get_default_resource()->deallocate(pointer, bytes, alignment);
+        return;
+    }
+    *static_cast<void **>(pointer) = free;
+    free = pointer;
+    --used;
+}
+
+bool EntityPool::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+bool EntityPool::pooled(size_t bytes, size_t alignment) const {
+    return alignment <= alignof(std::max_align_t) && bytes <= block && block < bytes + alignof(std::max_align_t);
+}
+
+void EntityPool::grow(size_t blocks) {
+    chunks.emplace_back(new std::byte[blocks * block]);
+    std::byte *chunk = chunks.back().get();
+    for (size_t i = blocks; i > 0; --i) {
+        void *pointer = chunk + (i - 1) * block;
+        *static_cast<void **>(pointer) = free;
+        free = pointer;
+    }
+    total += blocks;
+}
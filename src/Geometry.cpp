@@ -0,0 +1,375 @@
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#elif defined(__clang__)
+#pragma clang fp contract(off)
+#endif
+#include "Geometry.h"
+#include <atomic>
+#include <cmath>
+#include <limits>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEOMETRY_X86
+#include <immintrin.h>
+#endif
+
+// Fused multiply-add is disabled above: the vector kernels must round exactly like the scalar code.
+
+namespace {
+    struct Kernels {
+        void (*distances)(const double *, const double *, size_t, double, double, double *);
+        size_t (*nearest)(const double *, const double *, size_t, double, double);
+        void (*advance)(double *, double *, const double *, const double *, const double *, size_t);
+    };
+
+    inline void step(double &x, double &y, double toX, double toY, double speed) {
+        if (x == toX && y == toY) return;
+        double dx = toX - x;
+        double dy = toY - y;
+        double norm = std::sqrt(dx * dx + dy * dy);
+        double distance = norm < speed ? norm : speed;
+        dx = dx / norm * distance + x;
+        dy = dy / norm * distance + y;
+        double rx = toX - dx;
+        double ry = toY - dy;
+        if (std::sqrt(rx * rx + ry * ry) < Geometry::epsilon) {
+            dx = toX;
+            dy = toY;
+        }
+        x = dx;
+        y = dy;
+    }
+
+    inline double distance(double x0, double y0, double x, double y) {
+        double dx = x0 - x;
+        double dy = y0 - y;
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    void scalarDistances(const double *xs, const double *ys, size_t count, double x, double y, double *distances) {
+        for (size_t i = 0; i < count; ++i) {
+            distances[i] = distance(xs[i], ys[i], x, y);
+        }
+    }
+
+    size_t scalarNearest(const double *xs, const double *ys, size_t begin, size_t count, double x, double y, double best, size_t index) {
+        for (size_t i = begin; i < count; ++i) {
+            double d = distance(xs[i], ys[i], x, y);
+            if (d < best) {
+                best = d;
+                index = i;
+            }
+        }
+        return index;
+    }
+
+    size_t scalarNearest(const double *xs, const double *ys, size_t count, double x, double y) {
+        return scalarNearest(xs, ys, 0, count, x, y, std::numeric_limits<double>::infinity(), count);
+    }
+
+    void scalarAdvance(double *xs, double *ys, const double *toXs, const double *toYs, const double *speeds, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            step(xs[i], ys[i], toXs[i], toYs[i], speeds[i]);
+        }
+    }
+
+#ifdef GEOMETRY_X86
+    __attribute__((target("sse2")))
+    void sse2Distances(const double *xs, const double *ys, size_t count, double x, double y, double *distances) {
+        const __m128d px = _mm_set1_pd(x);
+        const __m128d py = _mm_set1_pd(y);
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), px);
+            __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), py);
+            _mm_storeu_pd(distances + i, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+        }
+        scalarDistances(xs + i, ys + i, count - i, x, y, distances + i);
+    }
+
+    __attribute__((target("sse2")))
+    size_t sse2Nearest(const double *xs, const double *ys, size_t count, double x, double y) {
+        const __m128d px = _mm_set1_pd(x);
+        const __m128d py = _mm_set1_pd(y);
+        const __m128d two = _mm_set1_pd(2);
+        __m128d best = _mm_set1_pd(std::numeric_limits<double>::infinity());
+        __m128d bestIndex = _mm_set1_pd((double)count);
+        __m128d index = _mm_set_pd(1, 0);
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), px);
+            __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), py);
+            __m128d d = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+            __m128d closer = _mm_cmplt_pd(d, best);
+            best = _mm_or_pd(_mm_and_pd(closer, d), _mm_andnot_pd(closer, best));
+            bestIndex = _mm_or_pd(_mm_and_pd(closer, index), _mm_andnot_pd(closer, bestIndex));
+            index = _mm_add_pd(index, two);
+        }
+        double lanes[2];
+        double indices[2];
+        _mm_storeu_pd(lanes, best);
+        _mm_storeu_pd(indices, bestIndex);
+        size_t lane = lanes[1] < lanes[0] || (lanes[1] == lanes[0] && indices[1] < indices[0]) ? 1 : 0;
+        return scalarNearest(xs, ys, i, count, x, y, lanes[lane], (size_t)indices[lane]);
+    }
+
+    __attribute__((target("sse2")))
+    void sse2Advance(double *xs, double *ys, const double *toXs, const double *toYs, const double *speeds, size_t count) {
+        const __m128d epsilon = _mm_set1_pd(Geometry::epsilon);
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            __m128d x = _mm_loadu_pd(xs + i);
+            __m128d y = _mm_loadu_pd(ys + i);
+            __m128d toX = _mm_loadu_pd(toXs + i);
+            __m128d toY = _mm_loadu_pd(toYs + i);
+            __m128d arrived = _mm_and_pd(_mm_cmpeq_pd(x, toX), _mm_cmpeq_pd(y, toY));
+            __m128d dx = _mm_sub_pd(toX, x);
+            __m128d dy = _mm_sub_pd(toY, y);
+            __m128d norm = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+            __m128d distance = _mm_min_pd(norm, _mm_loadu_pd(speeds + i));
+            dx = _mm_add_pd(_mm_mul_pd(_mm_div_pd(dx, norm), distance), x);
+            dy = _mm_add_pd(_mm_mul_pd(_mm_div_pd(dy, norm), distance), y);
+            __m128d rx = _mm_sub_pd(toX, dx);
+            __m128d ry = _mm_sub_pd(toY, dy);
+            __m128d snap = _mm_cmplt_pd(_mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(rx, rx), _mm_mul_pd(ry, ry))), epsilon);
+            dx = _mm_or_pd(_mm_and_pd(snap, toX), _mm_andnot_pd(snap, dx));
+            dy = _mm_or_pd(_mm_and_pd(snap, toY), _mm_andnot_pd(snap, dy));
+            _mm_storeu_pd(xs + i, _mm_or_pd(_mm_and_pd(arrived, x), _mm_andnot_pd(arrived, dx)));
+            _mm_storeu_pd(ys + i, _mm_or_pd(_mm_and_pd(arrived, y), _mm_andnot_pd(arrived, dy)));
+        }
+        scalarAdvance(xs + i, ys + i, toXs + i, toYs + i, speeds + i, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    void avx2Distances(const double *xs, const double *ys, size_t count, double x, double y, double *distances) {
+        const __m256d px = _mm256_set1_pd(x);
+        const __m256d py = _mm256_set1_pd(y);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), px);
+            __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), py);
+            _mm256_storeu_pd(distances + i, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+        }
+        scalarDistances(xs + i, ys + i, count - i, x, y, distances + i);
+    }
+
+    __attribute__((target("avx2")))
+    size_t avx2Nearest(const double *xs, const double *ys, size_t count, double x, double y) {
+        const __m256d px = _mm256_set1_pd(x);
+        const __m256d py = _mm256_set1_pd(y);
+        const __m256d four = _mm256_set1_pd(4);
+        __m256d best = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+        __m256d bestIndex = _mm256_set1_pd((double)count);
+        __m256d index = _mm256_set_pd(3, 2, 1, 0);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), px);
+            __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), py);
+            __m256d d = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+            __m256d closer = _mm256_cmp_pd(d, best, _CMP_LT_OQ);
+            best = _mm256_blendv_pd(best, d, closer);
+            bestIndex = _mm256_blendv_pd(bestIndex, index, closer);
+            index = _mm256_add_pd(index, four);
+        }
+        double lanes[4];
+        double indices[4];
+        _mm256_storeu_pd(lanes, best);
+        _mm256_storeu_pd(indices, bestIndex);
+        size_t lane = 0;
+        for (size_t j = 1; j < 4; ++j) {
+            if (lanes[j] < lanes[lane] || (lanes[j] == lanes[lane] && indices[j] < indices[lane])) lane = j;
+        }
+        return scalarNearest(xs, ys, i, count, x, y, lanes[lane], (size_t)indices[lane]);
+    }
+
+    __attribute__((target("avx2")))
+    void avx2Advance(double *xs, double *ys, const double *toXs, const double *toYs, const double *speeds, size_t count) {
+        const __m256d epsilon = _mm256_set1_pd(Geometry::epsilon);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m256d x = _mm256_loadu_pd(xs + i);
+            __m256d y = _mm256_loadu_pd(ys + i);
+            __m256d toX = _mm256_loadu_pd(toXs + i);
+            __m256d toY = _mm256_loadu_pd(toYs + i);
+            __m256d arrived = _mm256_and_pd(_mm256_cmp_pd(x, toX, _CMP_EQ_OQ), _mm256_cmp_pd(y, toY, _CMP_EQ_OQ));
+            __m256d dx = _mm256_sub_pd(toX, x);
+            __m256d dy = _mm256_sub_pd(toY, y);
+            __m256d norm = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+            __m256d distance = _mm256_min_pd(norm, _mm256_loadu_pd(speeds + i));
+            dx = _mm256_add_pd(_mm256_mul_pd(_mm256_div_pd(dx, norm), distance), x);
+            dy = _mm256_add_pd(_mm256_mul_pd(_mm256_div_pd(dy, norm), distance), y);
+            __m256d rx = _mm256_sub_pd(toX, dx);
+            __m256d ry = _mm256_sub_pd(toY, dy);
+            __m256d snap = _mm256_cmp_pd(_mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(rx, rx), _mm256_mul_pd(ry, ry))), epsilon, _CMP_LT_OQ);
+            dx = _mm256_blendv_pd(dx, toX, snap);
+            dy = _mm256_blendv_pd(dy, toY, snap);
+            _mm256_storeu_pd(xs + i, _mm256_blendv_pd(dx, x, arrived));
+            _mm256_storeu_pd(ys + i, _mm256_blendv_pd(dy, y, arrived));
+        }
+        scalarAdvance(xs + i, ys + i, toXs + i, toYs + i, speeds + i, count - i);
+    }
+
+    /**
+     * The unmasked square root and minimum take their unused source from _mm512_undefined_pd,
+     * which GCC 12 reports as maybe uninitialized. The zero-masked forms with every lane set compile to the same instructions.
+     */
+    __attribute__((target("avx512f")))
+    inline __m512d avx512Sqrt(__m512d a) {
+        return _mm512_maskz_sqrt_pd((__mmask8)0xFF, a);
+    }
+
+    __attribute__((target("avx512f")))
+    inline __m512d avx512Min(__m512d a, __m512d b) {
+        return _mm512_maskz_min_pd((__mmask8)0xFF, a, b);
+    }
+
+    __attribute__((target("avx512f")))
+    void avx512Distances(const double *xs, const double *ys, size_t count, double x, double y, double *distances) {
+        const __m512d px = _mm512_set1_pd(x);
+        const __m512d py = _mm512_set1_pd(y);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m512d dx = _mm512_sub_pd(_mm512_loadu_pd(xs + i), px);
+            __m512d dy = _mm512_sub_pd(_mm512_loadu_pd(ys + i), py);
+            _mm512_storeu_pd(distances + i, avx512Sqrt(_mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy))));
+        }
+        scalarDistances(xs + i, ys + i, count - i, x, y, distances + i);
+    }
+
+    __attribute__((target("avx512f")))
+    size_t avx512Nearest(const double *xs, const double *ys, size_t count, double x, double y) {
+        const __m512d px = _mm512_set1_pd(x);
+        const __m512d py = _mm512_set1_pd(y);
+        const __m512d eight = _mm512_set1_pd(8);
+        __m512d best = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+        __m512d bestIndex = _mm512_set1_pd((double)count);
+        __m512d index = _mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m512d dx = _mm512_sub_pd(_mm512_loadu_pd(xs + i), px);
+            __m512d dy = _mm512_sub_pd(_mm512_loadu_pd(ys + i), py);
+            __m512d d = avx512Sqrt(_mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy)));
+            __mmask8 closer = _mm512_cmp_pd_mask(d, best, _CMP_LT_OQ);
+            best = _mm512_mask_blend_pd(closer, best, d);
+            bestIndex = _mm512_mask_blend_pd(closer, bestIndex, index);
+            index = _mm512_add_pd(index, eight);
+        }
+        double lanes[8];
+        double indices[8];
+        _mm512_storeu_pd(lanes, best);
+        _mm512_storeu_pd(indices, bestIndex);
+        size_t lane = 0;
+        for (size_t j = 1; j < 8; ++j) {
+            if (lanes[j] < lanes[lane] || (lanes[j] == lanes[lane] && indices[j] < indices[lane])) lane = j;
+        }
+        return scalarNearest(xs, ys, i, count, x, y, lanes[lane], (size_t)indices[lane]);
+    }
+
+    __attribute__((target("avx512f")))
+    void avx512Advance(double *xs, double *ys, const double *toXs, const double *toYs, const double *speeds, size_t count) {
+        const __m512d epsilon = _mm512_set1_pd(Geometry::epsilon);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m512d x = _mm512_loadu_pd(xs + i);
+            __m512d y = _mm512_loadu_pd(ys + i);
+            __m512d toX = _mm512_loadu_pd(toXs + i);
+            __m512d toY = _mm512_loadu_pd(toYs + i);
+            __mmask8 arrived = _mm512_cmp_pd_mask(x, toX, _CMP_EQ_OQ) & _mm512_cmp_pd_mask(y, toY, _CMP_EQ_OQ);
+            __m512d dx = _mm512_sub_pd(toX, x);
+            __m512d dy = _mm512_sub_pd(toY, y);
+            __m512d norm = avx512Sqrt(_mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy)));
+            __m512d distance = avx512Min(norm, _mm512_loadu_pd(speeds + i));
+            dx = _mm512_add_pd(_mm512_mul_pd(_mm512_div_pd(dx, norm), distance), x);
+            dy = _mm512_add_pd(_mm512_mul_pd(_mm512_div_pd(dy, norm), distance), y);
+            __m512d rx = _mm512_sub_pd(toX, dx);
+            __m512d ry = _mm512_sub_pd(toY, dy);
+            __mmask8 snap = _mm512_cmp_pd_mask(avx512Sqrt(_mm512_add_pd(_mm512_mul_pd(rx, rx), _mm512_mul_pd(ry, ry))), epsilon, _CMP_LT_OQ);
+            dx = _mm512_mask_blend_pd(snap, dx, toX);
+            dy = _mm512_mask_blend_pd(snap, dy, toY);
+            _mm512_storeu_pd(xs + i, _mm512_mask_blend_pd(arrived, dx, x));
+            _mm512_storeu_pd(ys + i, _mm512_mask_blend_pd(arrived, dy, y));
+        }
+        scalarAdvance(xs + i, ys + i, toXs + i, toYs + i, speeds + i, count - i);
+    }
+#endif
+
+    const Kernels table[] = {
+        {scalarDistances, scalarNearest, scalarAdvance},
+#ifdef GEOMETRY_X86
+        {sse2Distances, sse2Nearest, sse2Advance},
+        {avx2Distances, avx2Nearest, avx2Advance},
+        {avx512Distances, avx512Nearest, avx512Advance},
+#endif
+    };
+
+    Geometry::Isa supported() {
+#ifdef GEOMETRY_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return Geometry::AVX512;
+        if (__builtin_cpu_supports("avx2")) return Geometry::AVX2;
+        if (__builtin_cpu_supports("sse2")) return Geometry::SSE2;
+#endif
+        return Geometry::SCALAR;
+    }
+
+    std::atomic<Geometry::Isa> &selected() {
+        static std::atomic<Geometry::Isa> isa(supported());
+        return isa;
+    }
+
+    const Kernels &kernels() {
+        return table[selected().load(std::memory_order_relaxed)];
+    }
+}
+
+void Geometry::distances(const double *xs, const double *ys, size_t count, double x, double y, double *distances) {
+    kernels().distances(xs, ys, count, x, y, distances);
+}
+
+size_t Geometry::nearest(const double *xs, const double *ys, size_t count, double x, double y) {
+    return kernels().nearest(xs, ys, count, x, y);
+}
+
+void Geometry::advance(double *xs, double *ys, const double *toXs, const double *toYs, const double *speeds, size_t count) {
+    kernels().advance(xs, ys, toXs, toYs, speeds, count);
+}
+
+void Geometry::advance(double &x, double &y, double toX, double toY, double speed) {
+    step(x, y, toX, toY, speed);
+}
+
+double Geometry::contact(double ax, double ay, double aToX, double aToY, double bx, double by, double bToX, double bToY, double radius) {
+    double px = ax - bx;
+    double py = ay - by;
+    double vx = (aToX - ax) - (bToX - bx);
+    double vy = (aToY - ay) - (bToY - by);
+    double c = px * px + py * py - radius * radius;
+    if (c <= 0) return 0;
+    double a = vx * vx + vy * vy;
+    double b = px * vx + py * vy;
+    if (a == 0 || b >= 0) return 2;
+    double discriminant = b * b - a * c;
+    if (discriminant < 0) return 2;
+    double t = (-b - std::sqrt(discriminant)) / a;
+    return t <= 1 ? t : 2;
+}
+
+Geometry::Isa Geometry::isa() {
+    return selected().load(std::memory_order_relaxed);
+}
+
+Geometry::Isa Geometry::setIsa(Geometry::Isa isa) {
+    Isa best = supported();
+    if (isa > best) isa = best;
+    selected().store(isa, std::memory_order_relaxed);
+    return isa;
+}
+
+const char *Geometry::name(Geometry::Isa isa) {
+    switch (isa) {
+        case SCALAR: return "scalar";
+        case SSE2: return "sse2";
+        case AVX2: return "avx2";
+        case AVX512: return "avx512";
+    }
+    return "unknown";
+}
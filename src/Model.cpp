@@ -1,230 +1,630 @@
 #include "Model.h"
-
-std::shared_ptr<Model> Model::instance = nullptr;
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <unordered_set>
+#include "Allocations.h"
+#include "Geometry.h"
 
 void Model::update() {
-    for (const auto &spaceship: spaceships) {
-        spaceship->update();
+    Allocations::Scope allocations(Allocations::TICK);
+    Profiler::Scope tick(profiler, Profiler::TICK);
+    {
+        Profiler::Scope phase(profiler, Profiler::DISPATCH);
+        dispatcher.dispatch(*this);
+    }
+    falconStarts.clear();
+    if (!rockets.empty()) {
+        for (const Handle<Spaceship> &falcon: falcons) {
+            Spaceship *spaceship = resolve(falcon);
+            falconStarts.push_back(spaceship != nullptr ? spaceship->getLocation() : Object::Point());
+        }
     }
-    for (const auto &site: sites) {
-        site->update();
+    {
+        Profiler::Scope phase(profiler, Profiler::SPACESHIPS);
+        Profiler::Split split(profiler);
+        for (auto iterator = active.begin(); iterator != active.end();) {
+            Spaceship &spaceship = *spaceshipRegistry.at(iterator->second);
+            split.enter((Profiler::Phase)(Profiler::SHUTTLES + spaceship.getKind()));
+            spaceship.update();
+            spaceshipGrid.move(spaceship.getHandle().getIndex(), spaceship.getLocation());
+            if (spaceship.isSteady()) {
+                spaceship.sleep();
+                if (spaceship.getKind() == Spaceship::SHUTTLE) resting.insert(*iterator);
+                iterator = active.erase(iterator);
+            } else {
+                ++iterator;
+            }
+        }
+    }
+    // Stations count their production from the time, which advances after the spaceships docked in this tick.
+    ++time;
+    economy.produced += productionRate;
+    {
+        Profiler::Scope phase(profiler, Profiler::ROCKETS);
+        updateRockets();
+    }
+    archive();
+}
+
+void Model::archive() {
+    std::vector<Handle<Spaceship>> pending;
+    for (const Handle<Spaceship> &handle: deaths) {
+        Spaceship *spaceship = resolve(handle);
+        if (spaceship == nullptr || spaceship->status() != Spaceship::DEAD) continue;
+        // Dying stops a spaceship, but a shuttle that died with jobs left still flies them, so it waits until it stands still with none.
+        if (!spaceship->isSteady()) {
+            pending.push_back(handle);
+            continue;
+        }
+        wrecks.add(*spaceship);
+        erase(*spaceship);
     }
-    for (auto &rocket: rockets) {
-        rocket->update();
+    deaths.swap(pending);
+}
+
+void Model::updateRockets() {
+    std::vector<Spaceship *> targets;
+    std::vector<SweepGrid::Sweep> targetPaths;
+    for (size_t i = 0; i < falcons.size() && i < falconStarts.size(); ++i) {
+        Spaceship *falcon = resolve(falcons[i]);
+        if (falcon == nullptr || falcon->status() == Spaceship::DEAD) continue;
+        Object::Point location = falcon->getLocation();
+        targets.push_back(falcon);
+        targetPaths.push_back({falconStarts[i][0], falconStarts[i][1], location[0], location[1]});
+    }
+    std::vector<bool> hit = collide(advanceRockets(), targetPaths);
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (hit[i]) targets[i]->die();
     }
 }
 
-void Model::createShuttle(const std::string &name, const std::string &agentName, double x, double y) {
-    try {
-        findSpaceship(name);
-        throw std::invalid_argument(name + " already exists.");
-    } catch (const std::out_of_range &exception) {
-        spaceships.emplace(std::make_shared<Shuttle>(name, agentName, Object::Point(x, y)));
+std::vector<Symbol> Model::updateRockets(const std::vector<Model::Target> &targets) {
+    Profiler::Scope phase(profiler, Profiler::ROCKETS);
+    std::vector<SweepGrid::Sweep> targetPaths;
+    for (const Target &target: targets) {
+        targetPaths.push_back(target.path);
+    }
+    std::vector<bool> hit = collide(advanceRockets(), targetPaths);
+    std::vector<Symbol> destroyed;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (hit[i]) destroyed.push_back(targets[i].name);
     }
+    return destroyed;
 }
 
-void Model::createBomber(const std::string &name, const std::string &agentName, const std::string &siteName) {
-    try {
-        findSpaceship(name);
-        throw std::invalid_argument(name + " already exists.");
-    } catch (const std::out_of_range &exception) {
-        spaceships.emplace(std::make_shared<Bomber>(name, agentName, findSite(siteName)));
+std::vector<SweepGrid::Sweep> Model::rocketPaths() const {
+    std::vector<SweepGrid::Sweep> paths;
+    for (const auto &rocket: rockets) {
+        Object::Point location = rocket->getLocation();
+        Object::Point destination = rocket->getDestination();
+        SweepGrid::Sweep path = {location[0], location[1], location[0], location[1]};
+        Geometry::advance(path.toX, path.toY, destination[0], destination[1], rocket->getSpeed());
+        paths.push_back(path);
+    }
+    return paths;
+}
+
+std::vector<std::shared_ptr<Destroyer::Rocket>> Model::takeRockets() {
+    std::vector<std::shared_ptr<Destroyer::Rocket>> taken;
+    taken.swap(rockets);
+    return taken;
+}
+
+std::vector<SweepGrid::Sweep> Model::advanceRockets() {
+    size_t count = rockets.size();
+    std::vector<double> xs(count);
+    std::vector<double> ys(count);
+    std::vector<double> toXs(count);
+    std::vector<double> toYs(count);
+    std::vector<double> speeds(count);
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = rockets[i]->getLocation()[0];
+        ys[i] = rockets[i]->getLocation()[1];
+        toXs[i] = rockets[i]->getDestination()[0];
+        toYs[i] = rockets[i]->getDestination()[1];
+        speeds[i] = rockets[i]->getSpeed();
     }
+    std::vector<SweepGrid::Sweep> paths(count);
+    for (size_t i = 0; i < count; ++i) {
+        paths[i].x = xs[i];
+        paths[i].y = ys[i];
+    }
+    Geometry::advance(xs.data(), ys.data(), toXs.data(), toYs.data(), speeds.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+        rockets[i]->advanceTo({xs[i], ys[i]});
+        paths[i].toX = rockets[i]->getLocation()[0];
+        paths[i].toY = rockets[i]->getLocation()[1];
+    }
+    return paths;
 }
 
-void Model::createDestroyer(const std::string &name, const std::string &agentName, double x, double y) {
-    try {
-        findSpaceship(name);
-        throw std::invalid_argument(name + " already exists.");
-    } catch (const std::out_of_range &exception) {
-        spaceships.emplace(std::make_shared<Destroyer>(name, agentName, Object::Point(x, y)));
+std::vector<bool> Model::collide(const std::vector<SweepGrid::Sweep> &paths, const std::vector<SweepGrid::Sweep> &targetPaths) {
+    double extent = 0;
+    for (const auto &path: paths) {
+        extent = std::max({extent, std::abs(path.toX - path.x), std::abs(path.toY - path.y)});
+    }
+    sweepGrid.build(targetPaths, blastRadius, extent);
+    std::vector<bool> exploded(paths.size(), false);
+    std::vector<bool> hit(targetPaths.size(), false);
+    std::vector<uint32_t> candidates;
+    std::vector<double> contacts;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        const SweepGrid::Sweep &path = paths[i];
+        sweepGrid.query(path, candidates);
+        contacts.assign(candidates.size(), 2);
+        double first = 2;
+        for (size_t j = 0; j < candidates.size(); ++j) {
+            if (hit[candidates[j]]) continue;
+            const SweepGrid::Sweep &target = targetPaths[candidates[j]];
+            contacts[j] = Geometry::contact(path.x, path.y, path.toX, path.toY, target.x, target.y, target.toX, target.toY, blastRadius);
+            first = std::min(first, contacts[j]);
+        }
+        bool arrived = rockets[i]->getLocation() == rockets[i]->getDestination();
+        if (first > 1 && !arrived) continue;
+        for (size_t j = 0; j < candidates.size(); ++j) {
+            const SweepGrid::Sweep &target = targetPaths[candidates[j]];
+            Object::Point location = {target.toX, target.toY};
+            if (first <= 1 ? contacts[j] == first : location.distance(rockets[i]->getLocation()) <= blastRadius) {
+                hit[candidates[j]] = true;
+            }
+        }
+        Tracer::instant("explode", rockets[i]->getSymbol());
+        exploded[i] = true;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!exploded[i]) rockets[kept++] = rockets[i];
     }
+    rockets.resize(kept);
+    return hit;
 }
 
-void Model::createFalcon(const std::string &name, double x, double y) {
-    try {
-        findSpaceship(name);
-        throw std::invalid_argument(name + " already exists.");
-    } catch (const std::out_of_range &exception) {
-        spaceships.emplace(std::make_shared<Falcon>(name, Object::Point(x, y)));
+void Model::createShuttle(Symbol name, Symbol agentName, double x, double y) {
+    checkName(name);
+    add(pools[SHUTTLES].create<Shuttle>(*this, name, agentName, Object::Point(x, y)));
+}
+
+void Model::createBomber(Symbol name, Symbol agentName, Symbol siteName) {
+    checkName(name);
+    add(pools[BOMBERS].create<Bomber>(*this, name, agentName, findSite(siteName)));
+}
+
+void Model::createDestroyer(Symbol name, Symbol agentName, double x, double y) {
+    checkName(name);
+    add(pools[DESTROYERS].create<Destroyer>(*this, name, agentName, Object::Point(x, y)));
+}
+
+void Model::createFalcon(Symbol name, double x, double y) {
+    checkName(name);
+    std::shared_ptr<Spaceship> falcon = pools[FALCONS].create<Falcon>(*this, name, Object::Point(x, y));
+    add(falcon);
+    falcons.push_back(falcon->getHandle());
+}
+
+void Model::checkName(Symbol name) const {
+    if (spaceshipNames.count(name) != 0 || wrecks.find(name) != nullptr) throw std::invalid_argument(name.str() + " already exists.");
+}
+
+void Model::remove(Symbol name) {
+    Spaceship &spaceship = findSpaceship(name);
+    if (spaceship.getAgent() != nullptr) agents.release(spaceship.getAgent()->getHandle());
+    erase(spaceship);
+}
+
+void Model::erase(Spaceship &spaceship) {
+    Symbol name = spaceship.getSymbol();
+    Handle<Spaceship> handle = spaceship.getHandle();
+    falcons.erase(std::remove(falcons.begin(), falcons.end(), handle), falcons.end());
+    spaceshipNames.erase(name);
+    spaceshipGrid.erase(handle.getIndex());
+    spaceshipRegistry.erase(handle);
+    active.erase({places[handle.getIndex()], handle.getIndex()});
+    resting.erase({places[handle.getIndex()], handle.getIndex()});
+    auto &fleet = fleets[spaceship.getKind()];
+    fleet.erase(fleet.find(name));
+    spaceships.erase(spaceships.find(name));
+}
+
+std::string Model::save(Symbol name) const {
+    Spaceship &spaceship = findSpaceship(name);
+    std::ostringstream stream;
+    stream << (int)spaceship.getKind() << ' ' << spaceship.getName() << ' ';
+    stream << (spaceship.getAgent() != nullptr ? spaceship.getAgent()->getName() : "-") << ' ';
+    if (spaceship.getKind() == Spaceship::BOMBER) {
+        stream << static_cast<Bomber &>(spaceship).getStart().getName() << ' ';
+    } else {
+        Utilities::writeExact(stream, spaceship.getLocation()[0]);
+        Utilities::writeExact(stream, spaceship.getLocation()[1]);
+    }
+    spaceship.save(stream);
+    return stream.str();
+}
+
+std::string Model::extract(Symbol name) {
+    std::string state = save(name);
+    remove(name);
+    return state;
+}
+
+void Model::insert(const std::vector<std::string> &states) {
+    std::vector<std::istringstream> streams;
+    std::vector<Symbol> names;
+    for (const std::string &state: states) {
+        std::istringstream &stream = streams.emplace_back(state);
+        int kind;
+        std::string word;
+        if (!(stream >> kind >> word)) throw std::invalid_argument("Malformed spaceship state: " + state);
+        Symbol name = Symbol::intern(word);
+        stream >> word;
+        Symbol agentName = Symbol::intern(word);
+        if (kind == Spaceship::BOMBER) {
+            stream >> word;
+            if (agents.find(agentName) == nullptr) createCommander(agentName);
+            createBomber(name, agentName, Symbol::intern(word));
+        } else {
+            double x = Utilities::readExact(stream);
+            double y = Utilities::readExact(stream);
+            if (kind == Spaceship::SHUTTLE) {
+                if (agents.find(agentName) == nullptr) createShipman(agentName);
+                createShuttle(name, agentName, x, y);
+            } else if (kind == Spaceship::DESTROYER) {
+                if (agents.find(agentName) == nullptr) createAdmiral(agentName);
+                createDestroyer(name, agentName, x, y);
+            } else if (kind == Spaceship::FALCON) {
+                createFalcon(name, x, y);
+            } else {
+                throw std::invalid_argument("Malformed spaceship state: " + state);
+            }
+        }
+        names.push_back(name);
+    }
+    for (size_t i = 0; i < names.size(); ++i) {
+        Spaceship &spaceship = findSpaceship(names[i]);
+        spaceship.restore(streams[i]);
+        spaceshipGrid.move(spaceship.getHandle().getIndex(), spaceship.getLocation());
+        if (spaceship.status() == Spaceship::DEAD) recordDeath(spaceship);
     }
 }
 
-void Model::createShipman(const std::string &name) {
+void Model::createShipman(Symbol name) {
     createAgent(name, ShipmanFactory());
 }
 
-void Model::createCommander(const std::string &name) {
+void Model::createCommander(Symbol name) {
     createAgent(name, CommanderFactory());
 }
 
-void Model::createAdmiral(const std::string &name) {
+void Model::createAdmiral(Symbol name) {
     createAgent(name, AdmiralFactory());
 }
 
-void Model::course(const std::string &name, double angle) const {
-    findSpaceship(name)->course(angle);
+void Model::course(Symbol name, double angle) const {
+    findSpaceship(name).course(angle);
 }
 
-void Model::course(const std::string &name, double angle, double speed) const {
-    findSpaceship(name)->course(angle, speed);
+void Model::course(Symbol name, double angle, double speed) const {
+    findSpaceship(name).course(angle, speed);
 }
 
-void Model::position(const std::string &name, double x, double y) const {
-    findSpaceship(name)->go({x, y});
+void Model::position(Symbol name, double x, double y) const {
+    findSpaceship(name).go({x, y});
 }
 
-void Model::destination(const std::string &name, const std::string &destination) const {
-    findSpaceship(name)->goTo(findSite(destination));
+void Model::destination(Symbol name, Symbol destination) const {
+    findSpaceship(name).goTo(findSite(destination));
 }
 
-void Model::stop(const std::string &name) const {
-    findSpaceship(name)->stop();
+void Model::stop(Symbol name) const {
+    findSpaceship(name).stop();
 }
 
-void Model::shoot(const std::string &name, double x, double y) const {
-    std::shared_ptr<Spaceship> spaceship = findSpaceship(name);
-    spaceship->shoot({x, y});
+void Model::shoot(Symbol name, double x, double y) const {
+    findSpaceship(name).shoot({x, y});
 }
 
-void Model::attack(const std::string &attackerName, const std::string &attackedName) const {
-    std::shared_ptr<Spaceship> attackerSpaceship = findSpaceship(attackerName);
-    std::shared_ptr<Spaceship> attackedSpaceship = findSpaceship(attackedName);
-    attackerSpaceship->attack(attackedSpaceship);
+void Model::attack(Symbol attackerName, Symbol attackedName) const {
+    Spaceship &attackerSpaceship = findSpaceship(attackerName);
+    // An archived victim is attacked like a dead one, so the command does not depend on when the archive ran.
+    const Wreck *wreck = wrecks.find(attackedName);
+    if (wreck != nullptr) {
+        attackerSpaceship.attack(*wreck);
+        return;
+    }
+    Spaceship &attackedSpaceship = findSpaceship(attackedName);
+    attackerSpaceship.attack(attackedSpaceship);
 }
 
-void Model::createFortressStar(const std::string &name, double x, double y, size_t count) {
+void Model::createFortressStar(Symbol name, double x, double y, size_t count) {
     try {
         findSite(name);
-        throw std::invalid_argument(name + " already exists.");
+        throw std::invalid_argument(name.str() + " already exists.");
     } catch (const std::out_of_range &exception) {
-        sites.emplace(std::make_shared<FortressStar>(name, Object::Point(x, y), count));
+        std::shared_ptr<Site> star = pools[STARS].create<FortressStar>(name, Object::Point(x, y), count);
+        add(star);
     }
 }
 
-void Model::createSpaceStation(const std::string &name, double x, double y, size_t count, size_t productionRate) {
+void Model::createSpaceStation(Symbol name, double x, double y, size_t count, size_t productionRate) {
     try {
         findSite(name);
-        throw std::invalid_argument(name + " already exists.");
+        throw std::invalid_argument(name.str() + " already exists.");
     } catch (const std::out_of_range &exception) {
-        sites.emplace(std::make_shared<SpaceStation>(name, Object::Point(x, y), count, productionRate));
-    }
-}
-
-Model &Model::get() {
-    if (instance == nullptr) {
-        instance = std::shared_ptr<Model>(new Model());
+        std::shared_ptr<Site> station = pools[STATIONS].create<SpaceStation>(*this, name, Object::Point(x, y), count, productionRate);
+        add(station);
+        this->productionRate += productionRate;
     }
-    return *instance;
 }
 
-void Model::transport(const std::string &spaceshipName, const std::string &stationName, const std::string &starName) const {
-    std::shared_ptr<Spaceship> spaceship = findSpaceship(spaceshipName);
-    std::shared_ptr<Site> fromSite = findSite(stationName);
-    std::shared_ptr<Site> toSite = findSite(starName);
-    std::shared_ptr<SpaceStation> station = std::dynamic_pointer_cast<SpaceStation>(fromSite);
-    std::shared_ptr<FortressStar> star = std::dynamic_pointer_cast<FortressStar>(toSite);
-    if (station == nullptr) throw std::invalid_argument(stationName + " is not a space station.");
-    if (star == nullptr) throw std::invalid_argument(starName + " is not a star.");
-    spaceship->transport(station, star);
+void Model::transport(Symbol spaceshipName, Symbol stationName, Symbol starName) const {
+    Spaceship &spaceship = findSpaceship(spaceshipName);
+    auto *station = dynamic_cast<SpaceStation *>(&findSite(stationName));
+    auto *star = dynamic_cast<FortressStar *>(&findSite(starName));
+    if (station == nullptr) throw std::invalid_argument(stationName.str() + " is not a space station.");
+    if (star == nullptr) throw std::invalid_argument(starName.str() + " is not a star.");
+    spaceship.transport(*station, *star);
 }
 
 Model::Model() :
+    pools(),
     spaceships(),
+    active(),
+    places(),
+    resting(),
+    fleets(),
+    spaceshipGrid(gridCell),
     sites(),
+    deaths(),
+    wrecks(gridCell),
+    siteIndex(),
     agents(),
-    rockets()
+    rockets(),
+    spaceshipRegistry(),
+    siteRegistry(),
+    spaceshipNames(),
+    siteNames(),
+    economy{0, 0, 0},
+    time(0),
+    productionRate(0),
+    dispatcher(),
+    falcons(),
+    falconStarts(),
+    sweepGrid(),
+    blastRadius(0),
+    profiler()
 {
-    createFortressStar("DS", 40 * scale, 10 * scale, 100000);
+    createFortressStar(Symbol::intern("DS"), 40 * scale, 10 * scale, 100000);
 }
 
-const std::shared_ptr<Spaceship> &Model::findSpaceship(const std::string &name) const {
-    auto iterator = std::find_if(spaceships.begin(), spaceships.end(), [&name](const std::shared_ptr<Spaceship> &spaceship) -> bool {
-        if (spaceship->getName() == name) return true;
-        return false;
-    });
-    if (iterator != spaceships.end()) return *iterator;
-    throw std::out_of_range("Did not find a spaceship named " + name + ".");
+Spaceship &Model::findSpaceship(Symbol name) const {
+    auto iterator = spaceshipNames.find(name);
+    if (iterator != spaceshipNames.end()) return *spaceshipRegistry.resolve(iterator->second);
+    if (wrecks.find(name) != nullptr) throw std::runtime_error(name.str() + " is dead and cannot operate.");
+    throw std::out_of_range("Did not find a spaceship named " + name.str() + ".");
 }
 
-const std::shared_ptr<Site> &Model::findSite(const std::string &name) const {
-    auto iterator = std::find_if(sites.begin(), sites.end(), [&name](const decltype(sites)::value_type &pair) -> bool {
-        if (pair->getName() == name) return true;
-        return false;
-    });
-    if (iterator != sites.end()) return *iterator;
-    throw std::out_of_range("Did not find a site named " + name + ".");
+Wreck *Model::findWreck(Symbol name) {
+    return wrecks.find(name);
 }
 
-void Model::explode(const Destroyer::Rocket &rocket) {
-    for (const std::shared_ptr<Spaceship> &spaceship: spaceships) {
-        if (spaceship->getLocation() == rocket.getLocation() && std::dynamic_pointer_cast<Falcon>(spaceship) != nullptr) {
-            spaceship->die();
-        }
-    }
-    auto it = std::remove_if(rockets.begin(), rockets.end(), [&rocket](const decltype(rockets)::value_type &rocket2) -> bool {
-        return &rocket == &*rocket2;
-    });
-    rockets.erase(it, rockets.end());
+Site &Model::findSite(Symbol name) const {
+    auto iterator = siteNames.find(name);
+    if (iterator != siteNames.end()) return *siteRegistry.resolve(iterator->second);
+    throw std::out_of_range("Did not find a site named " + name.str() + ".");
+}
+
+void Model::wake(const Spaceship &spaceship) {
+    uint32_t slot = spaceship.getHandle().getIndex();
+    if (spaceshipRegistry.at(slot) != &spaceship) return;
+    active.emplace(places[slot], slot);
+    resting.erase({places[slot], slot});
 }
 
 void Model::addRocket(const Destroyer::Rocket &rocket) {
-    rockets.push_back(std::make_shared<Destroyer::Rocket>(rocket));
+    rockets.push_back(pools[ROCKETS].create<Destroyer::Rocket>(rocket));
 }
 
-const std::shared_ptr<Agent> &Model::findAgent(const std::string &name) const {
-    auto iterator = std::find_if(agents.begin(), agents.end(), [&name](const decltype(agents)::value_type &pair) -> bool {
-        if (pair->getName() == name) return true;
-        return false;
-    });
-    if (iterator != agents.end()) return *iterator;
-    auto it = std::find_if(spaceships.begin(), spaceships.end(), [&name](const decltype(spaceships)::value_type &spaceship) -> bool {
-        if (spaceship->getAgent() == nullptr) return false;
-        return spaceship->getAgent()->getName() == name;
-    });
-    if (it != spaceships.end()) return (*it)->getAgent();
-    throw std::out_of_range("Did not find an agent named " + name + ".");
+Agent &Model::findAgent(Symbol name) const {
+    Agent *agent = agents.find(name);
+    if (agent != nullptr) return *agent;
+    throw std::out_of_range("Did not find an agent named " + name.str() + ".");
 }
 
-void Model::position(const std::string &name, double x, double y, double speed) const {
-    findSpaceship(name)->go({x, y}, speed);
+Spaceship *Model::resolve(const Handle<Spaceship> &handle) const {
+    return spaceshipRegistry.resolve(handle);
 }
 
-void Model::takeAgent(const std::string &name) {
-    auto it = std::find_if(agents.begin(), agents.end(), [&name](const decltype(agents)::value_type &agent) -> bool {
-        return agent->getName() == name;
-    });
-    if (it == agents.end()) throw std::out_of_range("The agent is already assigned");
-    agents.erase(findAgent(name));
+Site *Model::resolve(const Handle<Site> &handle) const {
+    return siteRegistry.resolve(handle);
+}
+
+Agent *Model::resolve(const Handle<Agent> &handle) const {
+    return agents.resolve(handle);
+}
+
+void Model::position(Symbol name, double x, double y, double speed) const {
+    findSpaceship(name).go({x, y}, speed);
+}
+
+void Model::takeAgent(Symbol name) {
+    agents.take(findAgent(name).getHandle());
+}
+
+void Model::releaseAgent(Symbol name) {
+    agents.release(findAgent(name).getHandle());
+}
+
+bool Model::isAssigned(Symbol name) const {
+    return agents.isAssigned(findAgent(name).getHandle());
 }
 
 const std::set<std::shared_ptr<Spaceship>, Model::ObjectComparator> &Model::getSpaceships() const {
     return spaceships;
 }
 
+const std::set<std::shared_ptr<Spaceship>, Model::ObjectComparator> &Model::getSpaceships(Spaceship::Kind kind) const {
+    return fleets[kind];
+}
+
+std::vector<const Spaceship *> Model::getActive() const {
+    std::vector<const Spaceship *> awake;
+    for (const auto &place: active) {
+        awake.push_back(spaceshipRegistry.at(place.second));
+    }
+    return awake;
+}
+
+std::vector<Shuttle *> Model::getIdleShuttles(std::pair<uint64_t, uint32_t> &cursor, size_t count) const {
+    std::vector<Shuttle *> idle;
+    auto iterator = resting.lower_bound(cursor);
+    for (size_t seen = 0; seen < resting.size() && idle.size() < count; ++seen, ++iterator) {
+        if (iterator == resting.end()) iterator = resting.begin();
+        auto *shuttle = static_cast<Shuttle *>(spaceshipRegistry.at(iterator->second));
+        if (shuttle->isIdle()) idle.push_back(shuttle);
+    }
+    cursor = iterator == resting.end() ? std::pair<uint64_t, uint32_t>() : *iterator;
+    return idle;
+}
+
+std::vector<const Spaceship *> Model::getDying() const {
+    std::vector<const Spaceship *> dying;
+    // A falcon in the blast of several rockets dies more than once.
+    std::unordered_set<const Spaceship *> seen;
+    for (const Handle<Spaceship> &handle: deaths) {
+        Spaceship *spaceship = resolve(handle);
+        if (spaceship != nullptr && spaceship->status() == Spaceship::DEAD && seen.insert(spaceship).second) dying.push_back(spaceship);
+    }
+    return dying;
+}
+
+void Model::findSpaceships(const Object::Point &center, double radius, std::vector<const Spaceship *> &found) const {
+    std::vector<uint32_t> ids;
+    spaceshipGrid.within(center, radius, ids);
+    for (uint32_t id: ids) {
+        const Spaceship *spaceship = spaceshipRegistry.at(id);
+        if (spaceship != nullptr) found.push_back(spaceship);
+    }
+}
+
 const std::set<std::shared_ptr<Site>, Model::ObjectComparator> &Model::getSites() const {
     return sites;
 }
 
-const std::set<std::shared_ptr<Agent>, Model::AgentComparator> &Model::getAgents() const {
-    return agents;
+const Archive &Model::getWrecks() const {
+    return wrecks;
+}
+
+std::vector<const Agent *> Model::getAgents() const {
+    return agents.unassigned();
 }
 
 const std::vector<std::shared_ptr<Destroyer::Rocket>> &Model::getRockets() const {
     return rockets;
 }
 
-void Model::createAgent(const std::string &name, const AgentFactory &factory) {
-    try {
-        findAgent(name);
-        throw std::invalid_argument(name + " already exists.");
-    } catch (const std::out_of_range &exception) {
-        agents.emplace(factory.create(name));
-    }
+const SiteIndex &Model::getSiteIndex() const {
+    return siteIndex;
+}
+
+const Model::Economy &Model::getEconomy() const {
+    return economy;
 }
 
-bool Model::isBomberNearby(const Object::Point &point) {
-    return std::any_of(spaceships.begin(), spaceships.end(), [&point](const decltype(spaceships)::value_type &spaceship) -> bool {
-        return point.distance(spaceship->getLocation()) <= 250 && std::dynamic_pointer_cast<Bomber>(spaceship);
+Dispatcher &Model::getDispatcher() {
+    return dispatcher;
+}
+
+const Profiler &Model::getProfiler() const {
+    return profiler;
+}
+
+size_t Model::getTime() const {
+    return time;
+}
+
+double Model::getBlastRadius() const {
+    return blastRadius;
+}
+
+void Model::setBlastRadius(double radius) {
+    if (radius < 0) throw std::invalid_argument("The blast radius cannot be negative.");
+    blastRadius = radius;
+}
+
+void Model::reserve(Model::Pooled type, size_t count) {
+    pools[type].reserve(count);
+}
+
+const EntityPool &Model::getPool(Model::Pooled type) const {
+    return pools[type];
+}
+
+void Model::recordDeath(const Spaceship &spaceship) {
+    deaths.push_back(spaceship.getHandle());
+}
+
+void Model::releaseStation(const Spaceship &shuttle) {
+    dispatcher.release(shuttle.getHandle());
+}
+
+void Model::recordDelivery(size_t count) {
+    economy.delivered += count;
+}
+
+void Model::recordTheft(size_t count) {
+    economy.stolen += count;
+}
+
+void Model::createAgent(Symbol name, const AgentFactory &factory) {
+    if (agents.find(name) != nullptr) throw std::invalid_argument(name.str() + " already exists.");
+    factory.create(name, agents);
+}
+
+bool Model::isBomberNearby(const Object::Point &point) const {
+    std::vector<const Spaceship *> found;
+    findSpaceships(point, 250, found);
+    return std::any_of(found.begin(), found.end(), [](const Spaceship *spaceship) -> bool {
+        return spaceship->getKind() == Spaceship::BOMBER;
     });
 }
+void Model::add(const std::shared_ptr<Spaceship> &spaceship) {
+    spaceship->setHandle(spaceshipRegistry.insert(spaceship));
+    spaceshipNames.emplace(spaceship->getSymbol(), spaceship->getHandle());
+    order(spaceships.emplace(spaceship).first);
+    uint32_t slot = spaceship->getHandle().getIndex();
+    active.emplace(places[slot], slot);
+    fleets[spaceship->getKind()].emplace(spaceship);
+    spaceshipGrid.insert(spaceship->getHandle().getIndex(), spaceship->getLocation());
+}
+
+void Model::order(std::set<std::shared_ptr<Spaceship>, ObjectComparator>::const_iterator position) {
+    constexpr uint64_t gap = (uint64_t)1 << 32;
+    uint64_t low = position == spaceships.begin() ? 0 : places[(*std::prev(position))->getHandle().getIndex()];
+    uint64_t high = std::next(position) == spaceships.end() ? UINT64_MAX : places[(*std::next(position))->getHandle().getIndex()];
+    uint32_t slot = (*position)->getHandle().getIndex();
+    if (places.size() <= slot) places.resize((size_t)slot + 1);
+    if (high - low >= 2) {
+        places[slot] = low + std::min(gap, (high - low) / 2);
+        return;
+    }
+    uint64_t next = 0;
+    for (const auto &spaceship: spaceships) {
+        next += gap;
+        places[spaceship->getHandle().getIndex()] = next;
+    }
+    // Renumbering moves the awake and resting spaceships too, so their sets are rebuilt in the same order.
+    for (auto *set: {&active, &resting}) {
+        std::set<std::pair<uint64_t, uint32_t>> renumbered;
+        for (const auto &place: *set) {
+            renumbered.emplace(places[place.second], place.second);
+        }
+        set->swap(renumbered);
+    }
+}
+
+void Model::add(const std::shared_ptr<Site> &site) {
+    site->setHandle(siteRegistry.insert(site));
+    siteNames.emplace(site->getSymbol(), site->getHandle());
+    sites.emplace(site);
+    siteIndex.add(site);
+}
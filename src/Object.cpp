@@ -1,25 +1,30 @@
 #include "Object.h"
+#include "Geometry.h"
 
 void Object::print(std::ostream &stream) const {
     printType(stream);
-    stream << " " << name << " at position " << location / 1000 << ".";
+    stream << " " << name << " at position " << getLocation() / 1000 << ".";
 }
 
 const std::string &Object::getName() const  {
+    return name.str();
+}
+
+Symbol Object::getSymbol() const {
     return name;
 }
 
-const Object::Point &Object::getLocation() const {
-    return location;
+Object::Point Object::getLocation() const {
+    return Coordinate::decode(location);
 }
 
 void Object::setLocation(const Object::Point &point) {
-    location = point;
+    location = Coordinate::encode(point);
 }
 
-Object::Object(std::string name, Object::Point location) :
-    name(std::move(name)),
-    location(std::move(location))
+Object::Object(Symbol name, Object::Point location) :
+    name(name),
+    location(Coordinate::encode(location))
 {
 
 }
@@ -33,33 +38,34 @@ std::ostream &operator<<(std::ostream &stream, const Object &object) {
     return stream;
 }
 
-MovingObject::MovingObject(const std::string &name, double speed, const Object::Point &location) :
+MovingObject::MovingObject(Symbol name, double speed, const Object::Point &location) :
     Object(name, location),
-    destination(location),
+    destination(Coordinate::encode(location)),
     speed(speed)
 {
 
 }
 
 void MovingObject::update() {
-    if (getLocation() == destination) return;
-    Point difference = destination - getLocation();
-    double distance = std::min(speed, difference.norm());
-    difference.normalize();
-    difference *= distance;
-    difference += getLocation();
-    setLocation(difference);
-    if ((destination - getLocation()).norm() < Point::epsilon) {
-        setLocation(destination);
+    Point location = getLocation();
+    Point target = getDestination();
+    Geometry::advance(location[0], location[1], target[0], target[1], speed);
+    advanceTo(location);
+}
+
+void MovingObject::advanceTo(const Object::Point &point) {
+    setLocation(point);
+    if (getLocation() != getDestination() && (getDestination() - getLocation()).norm() < Coordinate::epsilon) {
+        setLocation(getDestination());
     }
 }
 
-const Object::Point &MovingObject::getDestination() const {
-    return destination;
+Object::Point MovingObject::getDestination() const {
+    return Coordinate::decode(destination);
 }
 
 void MovingObject::go(const Object::Point &point) {
-    destination = point;
+    destination = Coordinate::encode(point);
 }
 
 void MovingObject::print(std::ostream &stream) const {
@@ -67,7 +73,7 @@ void MovingObject::print(std::ostream &stream) const {
     if (getLocation() == getDestination()) {
         stream << " not moving.";
     } else {
-        stream << " moving to " << destination / 1000 << " flying " << speed << " km/h.";
+        stream << " moving to " << getDestination() / 1000 << " flying " << speed << " km/h.";
     }
 }
 
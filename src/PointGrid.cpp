@@ -0,0 +1,74 @@
+#include "PointGrid.h"
+#include <algorithm>
+#include <cmath>
+
+PointGrid::PointGrid(double cell) : cell(cell), cells(), entries() {
+
+}
+
+void PointGrid::insert(uint32_t id, const Object::Point &point) {
+    if (entries.size() <= id) entries.resize((size_t)id + 1, {Object::Point(), 0, 0, false});
+    uint64_t k = keyOf(point);
+    std::vector<uint32_t> &members = cells[k];
+    entries[id] = {point, k, (uint32_t)members.size(), true};
+    members.push_back(id);
+}
+
+void PointGrid::move(uint32_t id, const Object::Point &point) {
+    if (id >= entries.size() || !entries[id].present) return;
+    if (keyOf(point) == entries[id].cell) {
+        entries[id].point = point;
+        return;
+    }
+    erase(id);
+    insert(id, point);
+}
+
+void PointGrid::erase(uint32_t id) {
+    if (id >= entries.size() || !entries[id].present) return;
+    Entry &entry = entries[id];
+    auto iterator = cells.find(entry.cell);
+    std::vector<uint32_t> &members = iterator->second;
+    members[entry.slot] = members.back();
+    entries[members.back()].slot = entry.slot;
+    members.pop_back();
+    if (members.empty()) cells.erase(iterator);
+    entry.present = false;
+}
+
+void PointGrid::within(const Object::Point &center, double radius, std::vector<uint32_t> &ids) const {
+    auto collect = [this, &center, radius, &ids](const std::vector<uint32_t> &members) -> void {
+        for (uint32_t id: members) {
+            if (entries[id].point.distance(center) <= radius) ids.push_back(id);
+        }
+    };
+    int64_t minX = cellOf(center[0] - radius);
+    int64_t maxX = cellOf(center[0] + radius);
+    int64_t minY = cellOf(center[1] - radius);
+    int64_t maxY = cellOf(center[1] + radius);
+    if ((double)(maxX - minX + 1) * (double)(maxY - minY + 1) > (double)cells.size()) {
+        for (const auto &members: cells) {
+            collect(members.second);
+        }
+        return;
+    }
+    for (int64_t x = minX; x <= maxX; ++x) {
+        for (int64_t y = minY; y <= maxY; ++y) {
+            auto iterator = cells.find(key(x, y));
+            if (iterator != cells.end()) collect(iterator->second);
+        }
+    }
+}
+
+int64_t PointGrid::cellOf(double coordinate) const {
+    // Clamped so a huge radius still converts; such a box covers more cells than are occupied anyway.
+    return (int64_t)std::clamp(std::floor(coordinate / cell), -2147483648.0, 2147483647.0);
+}
+
+uint64_t PointGrid::keyOf(const Object::Point &point) const {
+    return key(cellOf(point[0]), cellOf(point[1]));
+}
+
+uint64_t PointGrid::key(int64_t x, int64_t y) {
+    return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
@@ -0,0 +1,66 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <ostream>
+
+Profiler::Profiler() : samples(), counts() {
+
+}
+
+void Profiler::record(Profiler::Phase phase, uint64_t time) {
+    std::vector<uint64_t> &ring = samples[phase];
+    if (ring.size() < window) {
+        ring.push_back(time);
+    } else {
+        ring[counts[phase] % window] = time;
+    }
+    ++counts[phase];
+}
+
+double Profiler::rate() {
+#ifdef PROFILER_TSC
+    // The counter ticks at one rate for the whole process, so the first caller measures it for every profiler.
+    static const double calibrated = []() -> double {
+        uint64_t startStamp = now();
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        auto elapsed = [&startTime]() -> double {
+            return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+        };
+        while (elapsed() < 1e7) {
+        }
+        uint64_t stamp = now();
+        return (double)(stamp - startStamp) / elapsed();
+    }();
+    return calibrated;
+#else
+    return 1;
+#endif
+}
+
+void Profiler::print(std::ostream &stream) const {
+    if (!enabled) {
+        stream << "The profiler was compiled out with DISABLE_PROFILER." << std::endl;
+        return;
+    }
+    if (counts[TICK] == 0) {
+        stream << "No ticks were timed yet." << std::endl;
+        return;
+    }
+    double microsecond = rate() * 1000;
+    for (size_t phase = 0; phase < PHASES; ++phase) {
+        if (samples[phase].empty()) continue;
+        std::vector<uint64_t> sorted = samples[phase];
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted, microsecond](size_t percent) -> double {
+            return (double)sorted[(sorted.size() - 1) * percent / 100] / microsecond;
+        };
+        bool split = SHUTTLES <= phase && phase <= FALCONS;
+        stream << (split ? "  " : "") << name((Phase)phase) << ": p50 " << percentile(50) << " us, p99 " << percentile(99)
+               << " us, max " << (double)sorted.back() / microsecond << " us over the last " << sorted.size() << " ticks." << std::endl;
+    }
+    uint64_t total = 0;
+    for (uint64_t time: samples[TICK]) {
+        total += time;
+    }
+    stream << "Ticks per second: " << (double)samples[TICK].size() * microsecond * 1e6 / (double)std::max(total, (uint64_t)1)
+           << " over " << counts[TICK] << " ticks." << std::endl;
+}
@@ -0,0 +1,265 @@
+#include "Query.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    const char *const usage = "Usage: query <shuttle|bomber|destroyer|falcon|spaceship|station|fortress|site> [status <stopped|moving|docked|dead>] "
+                              "[within <distance> <site_name|(<x>, <y>)>] [toward <site_name>] [<crystals|health> <op> <value>]... [page <number> [<size>]]";
+
+    std::optional<double> readNumber(const std::string &arg) {
+        size_t end = 0;
+        double value = 0;
+        try {
+            value = std::stod(arg, &end);
+        } catch (const std::exception &exception) {
+            end = 0;
+        }
+        if (end != arg.size() || !std::isfinite(value)) return std::nullopt;
+        return value;
+    }
+
+    double parseNumber(const std::string &arg, const std::string &what) {
+        std::optional<double> value = readNumber(arg);
+        if (!value) throw std::invalid_argument(what + " must be a number.");
+        return *value;
+    }
+
+    const Site &findSite(const Model &model, const std::string &name) {
+        std::optional<Symbol> symbol = Symbol::find(name);
+        if (!symbol) throw std::out_of_range("Did not find a site named " + name + ".");
+        return model.findSite(*symbol);
+    }
+
+    /**
+     * A candidate that passed the filters, formatted only if it lands on the page.
+     */
+    struct Match {
+        const std::string *name;
+        const Spaceship *spaceship;
+        const Wreck *wreck;
+        const Site *site;
+    };
+}
+
+Query::Query(const std::vector<std::string> &args, const Model &model) :
+    type(SPACESHIP),
+    hasStatus(false),
+    status(Spaceship::STOPPED),
+    hasRegion(false),
+    center(),
+    radius(0),
+    hasToward(false),
+    toward(),
+    predicates(),
+    page(1),
+    pageSize(defaultPageSize)
+{
+    static const std::map<std::string, Type> types = {
+        {"shuttle", SHUTTLE}, {"bomber", BOMBER}, {"destroyer", DESTROYER}, {"falcon", FALCON},
+        {"spaceship", SPACESHIP}, {"station", STATION}, {"fortress", FORTRESS}, {"site", SITE},
+    };
+    static const std::map<std::string, Spaceship::Status> statuses = {
+        {"stopped", Spaceship::STOPPED}, {"moving", Spaceship::MOVING}, {"docked", Spaceship::DOCKED}, {"dead", Spaceship::DEAD},
+    };
+    static const std::map<std::string, Operator> operators = {
+        {"<", LESS}, {"<=", LESS_EQUAL}, {"=", EQUAL}, {"==", EQUAL}, {"!=", NOT_EQUAL}, {">=", GREATER_EQUAL}, {">", GREATER},
+    };
+    if (args.size() < 2 || types.count(args[1]) == 0) throw std::invalid_argument(usage);
+    type = types.at(args[1]);
+    size_t i = 2;
+    auto next = [&args, &i]() -> const std::string & {
+        if (i >= args.size()) throw std::invalid_argument(usage);
+        return args[i++];
+    };
+    while (i < args.size()) {
+        const std::string &keyword = next();
+        if (keyword == "status" && !hasStatus) {
+            auto found = statuses.find(next());
+            if (found == statuses.end()) throw std::invalid_argument(usage);
+            if (!isSpaceship()) throw std::invalid_argument("Sites have no status.");
+            hasStatus = true;
+            status = found->second;
+        } else if (keyword == "within" && !hasRegion) {
+            radius = parseNumber(next(), "The distance") * Model::scale;
+            if (radius < 0) throw std::invalid_argument("The distance cannot be negative.");
+            const std::string &place = next();
+            // Site names may start with a digit, so a place is only read as coordinates when no site has its name.
+            try {
+                center = findSite(model, place).getLocation();
+            } catch (const std::out_of_range &exception) {
+                std::optional<double> x = readNumber(place);
+                if (!x) throw;
+                center = Object::Point(*x * Model::scale, parseNumber(next(), "Coordinates") * Model::scale);
+            }
+            hasRegion = true;
+        } else if (keyword == "toward" && !hasToward) {
+            if (!isSpaceship()) throw std::invalid_argument("Sites do not move.");
+            toward = findSite(model, next()).getLocation();
+            hasToward = true;
+        } else if (keyword == "crystals" || keyword == "health") {
+            Field field = keyword == "crystals" ? CRYSTALS : HEALTH;
+            if (field == HEALTH && !isSpaceship()) throw std::invalid_argument("Sites have no health.");
+            auto found = operators.find(next());
+            if (found == operators.end()) throw std::invalid_argument("Unknown comparison. Use one of < <= = != >= >.");
+            predicates.push_back({field, found->second, parseNumber(next(), "The value")});
+        } else if (keyword == "page") {
+            page = parseCount(next(), "The page");
+            if (i < args.size()) pageSize = parseCount(next(), "The page size");
+            if (i < args.size()) throw std::invalid_argument(usage);
+        } else {
+            throw std::invalid_argument(usage);
+        }
+    }
+}
+
+Query::Result Query::match(const Model &model, const std::ostream &format, const std::function<bool(const Site &)> &includes) const {
+    std::vector<Match> hits;
+    if (isSpaceship()) {
+        auto keep = [this, &hits](const Spaceship &spaceship) -> void {
+            if (matches(spaceship)) hits.push_back({&spaceship.getName(), &spaceship, nullptr, nullptr});
+        };
+        std::vector<const Spaceship *> found;
+        if (hasRegion) {
+            model.findSpaceships(center, radius, found);
+        } else if ((hasStatus && status == Spaceship::MOVING) || hasToward) {
+            found = model.getActive();
+        } else if (hasStatus && status == Spaceship::DEAD) {
+            found = model.getDying();
+        } else if (type != SPACESHIP) {
+            for (const auto &spaceship: model.getSpaceships((Spaceship::Kind)type)) {
+                keep(*spaceship);
+            }
+        } else {
+            for (const auto &spaceship: model.getSpaceships()) {
+                keep(*spaceship);
+            }
+        }
+        for (const Spaceship *spaceship: found) {
+            keep(*spaceship);
+        }
+        // Archived spaceships are dead and stand still.
+        if ((!hasStatus || status == Spaceship::DEAD) && !hasToward) {
+            std::vector<const Wreck *> wrecks;
+            if (hasRegion) {
+                model.getWrecks().within(center, radius, wrecks);
+            } else if (type != SPACESHIP) {
+                wrecks = model.getWrecks().ofKind((Spaceship::Kind)type);
+            } else {
+                for (const auto &wreck: model.getWrecks()) {
+                    wrecks.push_back(&wreck.second);
+                }
+            }
+            for (const Wreck *wreck: wrecks) {
+                if (matches(*wreck)) hits.push_back({&wreck->getSymbol().str(), nullptr, wreck, nullptr});
+            }
+        }
+    } else {
+        auto keep = [this, &hits, &includes](const Site &site) -> void {
+            if (matches(site) && (!includes || includes(site))) hits.push_back({&site.getName(), nullptr, nullptr, &site});
+        };
+        if (hasRegion) {
+            const SiteIndex &index = model.getSiteIndex();
+            for (size_t id: index.within(center, radius)) {
+                keep(*index.get(id));
+            }
+        } else {
+            for (const auto &site: model.getSites()) {
+                keep(*site);
+            }
+        }
+    }
+    Result result{hits.size(), {}};
+    auto middle = hits.begin() + (long)std::min(limit(), hits.size());
+    std::partial_sort(hits.begin(), middle, hits.end(), [](const Match &a, const Match &b) -> bool {
+        return *a.name < *b.name;
+    });
+    for (auto match = hits.begin(); match != middle; ++match) {
+        std::ostringstream line;
+        line.copyfmt(format);
+        if (match->spaceship != nullptr) {
+            line << *match->spaceship;
+        } else if (match->wreck != nullptr) {
+            match->wreck->print(line, model);
+        } else {
+            line << *match->site;
+        }
+        result.lines.emplace_back(*match->name, line.str());
+    }
+    return result;
+}
+
+void Query::print(const Query::Result &result, std::ostream &output) const {
+    size_t begin = std::min((page - 1) * pageSize, result.lines.size());
+    size_t end = std::min(begin + pageSize, result.lines.size());
+    for (size_t i = begin; i < end; ++i) {
+        output << result.lines[i].second << std::endl;
+    }
+    size_t pages = std::max<size_t>(1, (result.total + pageSize - 1) / pageSize);
+    output << "Page " << page << " of " << pages << ", " << result.total << (result.total == 1 ? " match." : " matches.") << std::endl;
+}
+
+bool Query::Predicate::holds(size_t actual) const {
+    double number = (double)actual;
+    switch (op) {
+        case LESS: return number < value;
+        case LESS_EQUAL: return number <= value;
+        case EQUAL: return number == value;
+        case NOT_EQUAL: return number != value;
+        case GREATER_EQUAL: return number >= value;
+        case GREATER: return number > value;
+    }
+    return false;
+}
+
+size_t Query::parseCount(const std::string &arg, const std::string &what) {
+    double value = parseNumber(arg, what);
+    if (value < 1 || value > (double)maxPage || value != std::floor(value)) {
+        throw std::invalid_argument(what + " must be a whole number from 1 to " + std::to_string(maxPage) + ".");
+    }
+    return (size_t)value;
+}
+
+bool Query::isSpaceship() const {
+    return type <= SPACESHIP;
+}
+
+bool Query::matches(Spaceship::Kind kind) const {
+    return type == SPACESHIP || type == (Type)kind;
+}
+
+bool Query::matches(const Spaceship &spaceship) const {
+    if (!matches(spaceship.getKind())) return false;
+    Spaceship::Status current = spaceship.status();
+    if (hasStatus && current != status) return false;
+    if (hasRegion && spaceship.getLocation().distance(center) > radius) return false;
+    if (hasToward && (current != Spaceship::MOVING || !(spaceship.getDestination() == toward))) return false;
+    return std::all_of(predicates.begin(), predicates.end(), [&spaceship](const Predicate &predicate) -> bool {
+        return predicate.holds(predicate.field == CRYSTALS ? spaceship.getCrystals() : spaceship.getHealth());
+    });
+}
+
+bool Query::matches(const Wreck &wreck) const {
+    if (!matches(wreck.getKind())) return false;
+    if (hasRegion && wreck.getLocation().distance(center) > radius) return false;
+    return std::all_of(predicates.begin(), predicates.end(), [&wreck](const Predicate &predicate) -> bool {
+        return predicate.holds(predicate.field == CRYSTALS ? wreck.getCrystals() : 0);
+    });
+}
+
+bool Query::matches(const Site &site) const {
+    if (type == STATION && dynamic_cast<const SpaceStation *>(&site) == nullptr) return false;
+    if (type == FORTRESS && dynamic_cast<const FortressStar *>(&site) == nullptr) return false;
+    if (hasRegion && site.getLocation().distance(center) > radius) return false;
+    return std::all_of(predicates.begin(), predicates.end(), [&site](const Predicate &predicate) -> bool {
+        return predicate.holds(site.getCrystals());
+    });
+}
+
+size_t Query::limit() const {
+    return page * pageSize;
+}
@@ -0,0 +1,377 @@
+#include "Server.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Allocations.h"
+
+namespace {
+    void check(int result, const std::string &what) {
+        if (result < 0) throw std::runtime_error("Could not " + what + ": " + std::strerror(errno) + ".");
+    }
+
+    bool isPort(const std::string &address) {
+        return !address.empty() && address.size() <= 5 && std::all_of(address.begin(), address.end(), [](char c) -> bool {
+            return std::isdigit((unsigned char)c) != 0;
+        });
+    }
+}
+
+Server::Server(const std::string &address, double rate, size_t catchUp, std::ostream &log) :
+    address(address),
+    rate(rate),
+    log(log),
+    input(),
+    output(),
+    controller(input, output, output),
+    clock(rate, catchUp),
+    epoll(-1),
+    listener(-1),
+    timer(-1),
+    signals(-1),
+    consoleFlags(-1),
+    clients(),
+    batch(),
+    nextClient(CLIENTS),
+    sequence(0),
+    running(false)
+{
+    output.copyfmt(log);
+}
+
+Server::~Server() {
+    while (!clients.empty()) {
+        disconnect(clients.begin()->first);
+    }
+    for (int descriptor: {signals, timer, listener, epoll}) {
+        if (descriptor >= 0) close(descriptor);
+    }
+    if (listener >= 0 && !isPort(address)) unlink(address.c_str());
+    if (consoleFlags >= 0) fcntl(STDIN_FILENO, F_SETFL, consoleFlags);
+}
+
+bool Server::run(const std::string &path, size_t shards) {
+    try {
+        controller.open(path, shards);
+        listen();
+    } catch (const std::exception &exception) {
+        log << exception.what() << std::endl;
+        return false;
+    }
+    running = true;
+    if (isConsole()) {
+        consoleFlags = fcntl(STDIN_FILENO, F_GETFL);
+        if (consoleFlags >= 0) fcntl(STDIN_FILENO, F_SETFL, consoleFlags | O_NONBLOCK);
+        connect(STDIN_FILENO, STDOUT_FILENO);
+    } else {
+        log << "Serving on " << address << " at " << rate << " ticks per second." << std::endl;
+    }
+    schedule();
+    epoll_event events[64];
+    while (running) {
+        int count = epoll_wait(epoll, events, 64, -1);
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0) {
+            log << "Could not wait for events: " << std::strerror(errno) << "." << std::endl;
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            uint64_t key = events[i].data.u64;
+            if (key == LISTENER) {
+                accept();
+            } else if (key == TIMER) {
+                uint64_t expirations;
+                if (::read(timer, &expirations, sizeof(expirations)) != sizeof(expirations)) continue;
+                for (size_t due = clock.due(); due > 0 && running; --due) {
+                    tick();
+                }
+                schedule();
+            } else if (key == SIGNALS) {
+                signalfd_siginfo signal{};
+                if (::read(signals, &signal, sizeof(signal)) == sizeof(signal)) running = false;
+            } else if (clients.count(key) != 0) {
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) read(key);
+                // A socket that hung up both ways cannot take its replies, the console only reached the end of its input.
+                if (!isConsole() && clients.count(key) != 0 && (events[i].events & (EPOLLHUP | EPOLLERR))) disconnect(key);
+                if (clients.count(key) != 0 && (events[i].events & EPOLLOUT)) write(key);
+            }
+        }
+    }
+    controller.execute("exit");
+    log << output.str();
+    output.str("");
+    if (!isConsole()) {
+        clock.print(log);
+        log << "Stopped serving." << std::endl;
+    }
+    return true;
+}
+
+void Server::listen() {
+    if (isPort(address)) {
+        listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        check(listener, "create a socket");
+        int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in socketAddress{};
+        socketAddress.sin_family = AF_INET;
+        socketAddress.sin_port = htons((uint16_t)std::stoul(address));
+        socketAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        check(bind(listener, reinterpret_cast<sockaddr *>(&socketAddress), sizeof(socketAddress)), "bind to port " + address);
+    } else if (!isConsole()) {
+        sockaddr_un socketAddress{};
+        if (address.size() >= sizeof(socketAddress.sun_path)) throw std::invalid_argument("The socket path " + address + " is too long.");
+        listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        check(listener, "create a socket");
+        socketAddress.sun_family = AF_UNIX;
+        std::strncpy(socketAddress.sun_path, address.c_str(), sizeof(socketAddress.sun_path) - 1);
+        unlink(address.c_str());
+        check(bind(listener, reinterpret_cast<sockaddr *>(&socketAddress), sizeof(socketAddress)), "bind to " + address);
+    }
+    epoll = epoll_create1(EPOLL_CLOEXEC);
+    check(epoll, "create an epoll instance");
+    if (listener >= 0) {
+        check(::listen(listener, SOMAXCONN), "listen on " + address);
+        watch(listener, LISTENER, EPOLLIN);
+    }
+    // steady_clock is CLOCK_MONOTONIC, so the timer fires at the time points the TickClock gives.
+    timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    check(timer, "create a timer");
+    watch(timer, TIMER, EPOLLIN);
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    check(sigprocmask(SIG_BLOCK, &set, nullptr), "block the signals");
+    signals = signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+    check(signals, "watch the signals");
+    watch(signals, SIGNALS, EPOLLIN);
+}
+
+void Server::watch(int descriptor, uint64_t key, uint32_t events) {
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = key;
+    check(epoll_ctl(epoll, EPOLL_CTL_ADD, descriptor, &event), "watch a descriptor");
+}
+
+void Server::accept() {
+    while (true) {
+        int descriptor = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (descriptor < 0 && errno == EINTR) continue;
+        if (descriptor < 0) return;
+        connect(descriptor, descriptor);
+    }
+}
+
+void Server::connect(int source, int sink) {
+    uint64_t id = nextClient++;
+    clients[id] = {source, sink, "", "Time " + std::to_string(controller.getTime()) + ": ", false};
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.u64 = id;
+    if (epoll_ctl(epoll, EPOLL_CTL_ADD, source, &event) < 0) {
+        // epoll refuses regular files, which are read at once instead.
+        if (!isConsole() || errno != EPERM) {
+            log << "Could not watch a client: " << std::strerror(errno) << "." << std::endl;
+            disconnect(id);
+            return;
+        }
+        read(id);
+    }
+    if (!isConsole()) log << "Client " << id - CLIENTS << " connected." << std::endl;
+    if (clients.count(id) != 0) write(id);
+}
+
+void Server::read(uint64_t id) {
+    Client &client = clients.at(id);
+    if (client.closing) return;
+    char buffer[4096];
+    bool ended = false;
+    bool closed = false;
+    while (true) {
+        ssize_t count = ::read(client.source, buffer, sizeof(buffer));
+        if (count > 0) {
+            client.input.append(buffer, (size_t)count);
+        } else if (count < 0 && errno == EINTR) {
+            continue;
+        } else {
+            ended = count == 0;
+            closed = count < 0 && errno != EAGAIN && errno != EWOULDBLOCK;
+            break;
+        }
+    }
+    TickClock::Clock::time_point received = TickClock::Clock::now();
+    size_t start = 0;
+    for (size_t end; (end = client.input.find('\n', start)) != std::string::npos; start = end + 1) {
+        std::string line = client.input.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        batch.push_back({id, sequence++, line, received});
+    }
+    client.input.erase(0, start);
+    if (client.input.size() > maxLine) {
+        log << "Client " << id - CLIENTS << " sent a line longer than " << maxLine << " bytes." << std::endl;
+        closed = true;
+    }
+    if (ended && !closed && !client.input.empty()) {
+        batch.push_back({id, sequence++, client.input, received});
+        client.input.clear();
+    }
+    // Commands a client sent before it left stay in the batch, it just gets no replies.
+    if (closed) {
+        disconnect(id);
+    } else if (ended) {
+        finish(id);
+    }
+}
+
+void Server::write(uint64_t id) {
+    Client &client = clients.at(id);
+    size_t written = 0;
+    while (written < client.output.size()) {
+        const char *data = client.output.data() + written;
+        size_t size = client.output.size() - written;
+        ssize_t count = isConsole() ? ::write(client.sink, data, size) : send(client.sink, data, size, MSG_NOSIGNAL);
+        if (count > 0) {
+            written += (size_t)count;
+        } else if (count < 0 && errno == EINTR) {
+            continue;
+        } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            disconnect(id);
+            return;
+        }
+    }
+    client.output.erase(0, written);
+    bool queued = std::any_of(batch.begin(), batch.end(), [id](const Command &command) -> bool {
+        return command.client == id;
+    });
+    if (client.output.empty() && client.closing && !queued) {
+        disconnect(id);
+        return;
+    }
+    if (client.output.size() > maxOutput) {
+        log << "Client " << id - CLIENTS << " fell more than " << maxOutput << " bytes behind." << std::endl;
+        disconnect(id);
+        return;
+    }
+    if (isConsole()) return;
+    epoll_event event{};
+    event.events = (client.closing ? 0u : (uint32_t)(EPOLLIN | EPOLLRDHUP)) | (client.output.empty() ? 0u : (uint32_t)EPOLLOUT);
+    event.data.u64 = id;
+    epoll_ctl(epoll, EPOLL_CTL_MOD, client.source, &event);
+}
+
+void Server::finish(uint64_t id) {
+    Client &client = clients.at(id);
+    if (client.closing) return;
+    client.closing = true;
+    if (isConsole()) {
+        epoll_ctl(epoll, EPOLL_CTL_DEL, client.source, nullptr);
+        return;
+    }
+    epoll_event event{};
+    event.events = client.output.empty() ? 0u : (uint32_t)EPOLLOUT;
+    event.data.u64 = id;
+    epoll_ctl(epoll, EPOLL_CTL_MOD, client.source, &event);
+}
+
+void Server::disconnect(uint64_t id) {
+    auto client = clients.find(id);
+    if (client == clients.end()) return;
+    int descriptor = client->second.source;
+    epoll_ctl(epoll, EPOLL_CTL_DEL, descriptor, nullptr);
+    clients.erase(client);
+    // The console is the standard streams of the process, which stay open, and the world ends with it.
+    if (isConsole()) {
+        running = false;
+        return;
+    }
+    close(descriptor);
+    log << "Client " << id - CLIENTS << " disconnected." << std::endl;
+}
+
+void Server::schedule() {
+    auto next = std::chrono::duration_cast<std::chrono::nanoseconds>(clock.next().time_since_epoch()).count();
+    itimerspec expiry{};
+    expiry.it_value.tv_sec = (time_t)(next / 1000000000);
+    expiry.it_value.tv_nsec = (long)(next % 1000000000);
+    if (expiry.it_value.tv_sec == 0 && expiry.it_value.tv_nsec == 0) expiry.it_value.tv_nsec = 1;
+    check(timerfd_settime(timer, TFD_TIMER_ABSTIME, &expiry, nullptr), "arm the timer");
+}
+
+bool Server::isConsole() const {
+    return address.empty();
+}
+
+void Server::tick() {
+    TickClock::Clock::time_point begin = TickClock::Clock::now();
+    std::vector<Command> commands;
+    commands.swap(batch);
+    std::sort(commands.begin(), commands.end(), [](const Command &a, const Command &b) -> bool {
+        return a.client != b.client ? a.client < b.client : a.sequence < b.sequence;
+    });
+    std::set<uint64_t> exited;
+    std::vector<TickClock::Clock::time_point> applied;
+    std::vector<std::pair<uint64_t, std::string>> replies;
+    for (const Command &command: commands) {
+        if (exited.count(command.client) != 0) continue;
+        applied.push_back(command.received);
+        std::vector<std::string> args = Utilities::split(command.line);
+        if (!args.empty() && args[0] == "exit") {
+            exited.insert(command.client);
+            continue;
+        }
+        if (!args.empty() && args[0] == "go") {
+            output << "The server advances the time by itself." << std::endl;
+        } else if (!args.empty() && args[0] == "clock") {
+            if (args.size() != 1) {
+                output << "Usage: clock" << std::endl;
+            } else {
+                clock.print(output);
+            }
+        } else {
+            Allocations::Scope scope(Allocations::CONTROLLER);
+            controller.execute(command.line);
+        }
+        replies.emplace_back(command.client, output.str());
+        output.str("");
+    }
+    controller.execute("go");
+    output.str("");
+    // Like the console, the prompt shows the time the next command takes effect, after this tick.
+    std::string prompt = "Time " + std::to_string(controller.getTime()) + ": ";
+    for (const auto &reply: replies) {
+        auto client = clients.find(reply.first);
+        if (client != clients.end()) client->second.output += reply.second + prompt;
+    }
+    for (uint64_t id: exited) {
+        if (clients.count(id) != 0) finish(id);
+    }
+    TickClock::Clock::time_point end = TickClock::Clock::now();
+    clock.recordTick(end - begin);
+    for (TickClock::Clock::time_point received: applied) {
+        clock.recordLatency(end - received);
+    }
+    std::vector<uint64_t> pending;
+    for (const auto &client: clients) {
+        if (!client.second.output.empty() || client.second.closing) pending.push_back(client.first);
+    }
+    for (uint64_t id: pending) {
+        write(id);
+    }
+}
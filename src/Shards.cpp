@@ -0,0 +1,514 @@
+#include "Shards.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Controller.h"
+
+namespace {
+    std::string join(const std::vector<std::string> &args) {
+        std::string line;
+        for (const std::string &arg: args) {
+            if (!line.empty()) line += ' ';
+            line += arg;
+        }
+        return line;
+    }
+
+    std::string write(const SweepGrid::Sweep &path) {
+        std::ostringstream stream;
+        for (double value: {path.x, path.y, path.toX, path.toY}) {
+            Utilities::writeExact(stream, value);
+        }
+        return stream.str();
+    }
+
+    SweepGrid::Sweep readPath(std::istream &stream) {
+        SweepGrid::Sweep path{};
+        for (double *value: {&path.x, &path.y, &path.toX, &path.toY}) {
+            *value = Utilities::readExact(stream);
+        }
+        return path;
+    }
+
+    /**
+     * Get the name of a spaceship from its state, the second word.
+     */
+    Symbol nameOf(const std::string &state) {
+        std::istringstream stream(state);
+        std::string word;
+        stream >> word >> word;
+        return Symbol::intern(word);
+    }
+
+    /**
+     * Get the shards other than the owner a bomber at a position is copied into, as a list of indices.
+     */
+    std::string copies(const Shards::Strips &strips, size_t owner, double x, double halo) {
+        std::string indices;
+        for (size_t strip = 0; strip < strips.count; ++strip) {
+            if (strip != owner && strips.distance(strip, x) <= halo) indices += std::to_string(strip) + ' ';
+        }
+        return indices;
+    }
+}
+
+size_t Shards::Strips::of(double x) const {
+    if (width <= 0) return 0;
+    double strip = std::floor((x - minX) / width);
+    if (strip < 0) return 0;
+    return std::min((size_t)strip, count - 1);
+}
+
+double Shards::Strips::distance(size_t strip, double x) const {
+    double left = strip == 0 ? -INFINITY : minX + (double)strip * width;
+    double right = strip + 1 == count ? INFINITY : minX + (double)(strip + 1) * width;
+    return std::max({0.0, left - x, x - right});
+}
+
+Shards::Shards(Model &hub, const std::string &path, size_t count) :
+    hub(hub),
+    strips{INFINITY, 0, count},
+    channels(),
+    children(),
+    owners()
+{
+    double maxX = -INFINITY;
+    for (const auto &site: hub.getSites()) {
+        strips.minX = std::min(strips.minX, site->getLocation()[0]);
+        maxX = std::max(maxX, site->getLocation()[0]);
+    }
+    strips.width = (maxX - strips.minX) / (double)count;
+    for (size_t i = 0; i < count; ++i) {
+        auto ends = Channel::pair();
+        std::cout.flush();
+        std::cerr.flush();
+        pid_t child = fork();
+        if (child < 0) throw std::runtime_error("Could not start shard " + std::to_string(i) + ".");
+        if (child == 0) {
+            for (Channel &channel: channels) {
+                channel.close();
+            }
+            ends.first.close();
+            int status = 0;
+            try {
+                serve(ends.second, path, strips, i);
+            } catch (const std::exception &exception) {
+                std::cerr << "Shard " << i << ": " << exception.what() << std::endl;
+                status = 1;
+            }
+            _exit(status);
+        }
+        ends.second.close();
+        channels.push_back(std::move(ends.first));
+        children.push_back(child);
+    }
+}
+
+Shards::~Shards() {
+    for (Channel &channel: channels) {
+        try {
+            channel.send({"exit"});
+        } catch (const std::exception &exception) {
+            // The shard is gone already.
+        }
+        channel.close();
+    }
+    for (pid_t child: children) {
+        waitpid(child, nullptr, 0);
+    }
+}
+
+bool Shards::creates(const std::string &type) {
+    return type == "shuttle" || type == "bomber" || type == "destroyer" || type == "falcon";
+}
+
+void Shards::create(const std::vector<std::string> &args, std::ostream &output) {
+    const std::string &type = args[1];
+    // Malformed commands go to the first shard, which rejects them with the same error as a single world.
+    bool valid = false;
+    size_t shard = 0;
+    try {
+        if (type == "bomber" && args.size() == 5) {
+            valid = true;
+            std::optional<Symbol> site = Symbol::find(args[4]);
+            if (site) shard = strips.of(hub.findSite(*site).getLocation()[0]);
+        } else if (type == "falcon" && args.size() == 5) {
+            std::stod(args[4]);
+            shard = strips.of(std::stod(args[3]) * Model::scale);
+            valid = true;
+        } else if (type != "falcon" && args.size() == 6) {
+            std::stod(args[5]);
+            shard = strips.of(std::stod(args[4]) * Model::scale);
+            valid = true;
+        }
+    } catch (const std::exception &exception) {
+        shard = 0;
+    }
+    if (valid && owners.find(Symbol::intern(args[2])) != owners.end()) throw std::invalid_argument(args[2] + " already exists.");
+    std::string agentName = type != "falcon" && args.size() > 3 ? args[3] : "";
+    forward(shard, args, agentName, output);
+    owners[Symbol::intern(args[2])] = shard;
+    if (!agentName.empty()) hub.takeAgent(Symbol::intern(agentName));
+}
+
+void Shards::command(const std::vector<std::string> &args, std::ostream &output) {
+    std::optional<Symbol> name = Symbol::find(args[0]);
+    auto owner = name ? owners.find(*name) : owners.end();
+    if (owner == owners.end()) throw std::out_of_range("Did not find a spaceship named " + args[0] + ".");
+    std::optional<Symbol> victimName = args[1] == "attack" && args.size() == 3 ? Symbol::find(args[2]) : std::nullopt;
+    if (victimName) {
+        auto victim = owners.find(*victimName);
+        if (victim != owners.end() && victim->second != owner->second) move(*name, victim->second);
+    }
+    forward(owners.at(*name), args, "", output);
+}
+
+void Shards::broadcast(const std::vector<std::string> &args, std::ostream &output) {
+    for (size_t shard = 0; shard < channels.size(); ++shard) {
+        forward(shard, args, "", output);
+    }
+}
+
+void Shards::update() {
+    for (Channel &channel: channels) {
+        channel.send({"migrate"});
+    }
+    std::vector<std::vector<std::string>> newcomers(channels.size());
+    std::vector<std::vector<std::string>> copied(channels.size());
+    for (Channel &channel: channels) {
+        std::vector<std::string> reply = channel.receive();
+        for (size_t i = 0; i + 2 < reply.size(); i += 3) {
+            const std::string &state = reply[i + 2];
+            if (reply[i] != "-") {
+                size_t shard = std::stoull(reply[i]);
+                newcomers[shard].push_back(state);
+                owners[nameOf(state)] = shard;
+            }
+            std::istringstream indices(reply[i + 1]);
+            for (size_t shard; indices >> shard;) {
+                copied[shard].push_back(state);
+            }
+        }
+    }
+    std::vector<std::string> paths;
+    for (const SweepGrid::Sweep &path: hub.rocketPaths()) {
+        paths.push_back(write(path));
+    }
+    for (size_t shard = 0; shard < channels.size(); ++shard) {
+        std::ostringstream radius;
+        Utilities::writeExact(radius, hub.getBlastRadius());
+        std::vector<std::string> message = {"tick", radius.str(), std::to_string(newcomers[shard].size())};
+        message.insert(message.end(), newcomers[shard].begin(), newcomers[shard].end());
+        message.push_back(std::to_string(copied[shard].size()));
+        message.insert(message.end(), copied[shard].begin(), copied[shard].end());
+        message.insert(message.end(), paths.begin(), paths.end());
+        channels[shard].send(message);
+    }
+    std::vector<Model::Target> targets;
+    for (Channel &channel: channels) {
+        for (const std::string &field: channel.receive()) {
+            std::istringstream stream(field);
+            std::string name;
+            stream >> name;
+            targets.push_back({Symbol::intern(name), readPath(stream)});
+        }
+    }
+    std::vector<std::vector<std::string>> kills(channels.size(), {"kill"});
+    for (Symbol name: hub.updateRockets(targets)) {
+        kills[owners.at(name)].push_back(name.str());
+    }
+    for (size_t shard = 0; shard < channels.size(); ++shard) {
+        if (kills[shard].size() > 1) request(shard, kills[shard]);
+    }
+}
+
+void Shards::status(std::ostream &output) {
+    for (Channel &channel: channels) {
+        channel.send({"status"});
+    }
+    std::map<std::string, std::string> spaceships;
+    std::map<std::string, std::string> sites;
+    for (Channel &channel: channels) {
+        std::vector<std::string> reply = channel.receive();
+        size_t count = std::stoull(reply[0]);
+        for (size_t i = 1; i + 1 < reply.size(); i += 2) {
+            (i < 1 + 2 * count ? spaceships : sites).emplace(reply[i], reply[i + 1]);
+        }
+    }
+    for (const auto &spaceship: spaceships) {
+        output << spaceship.second << std::endl;
+    }
+    for (const auto &site: sites) {
+        output << site.second << std::endl;
+    }
+    for (const auto &agent: hub.getAgents()) {
+        output << *agent << std::endl;
+    }
+    for (const auto &rocket: hub.getRockets()) {
+        output << *rocket << std::endl;
+    }
+}
+
+void Shards::query(const Query &query, const std::vector<std::string> &args, std::ostream &output) {
+    for (Channel &channel: channels) {
+        channel.send({"query", join(args)});
+    }
+    Query::Result result{0, {}};
+    std::map<std::string, std::string> lines;
+    for (Channel &channel: channels) {
+        std::vector<std::string> reply = channel.receive();
+        result.total += std::stoull(reply[0]);
+        for (size_t i = 1; i + 1 < reply.size(); i += 2) {
+            lines.emplace(reply[i], reply[i + 1]);
+        }
+    }
+    result.lines.assign(lines.begin(), lines.end());
+    query.print(result, output);
+}
+
+Model::Economy Shards::economy() {
+    Model::Economy economy{0, 0, 0};
+    for (size_t shard = 0; shard < channels.size(); ++shard) {
+        std::vector<std::string> reply = request(shard, {"economy"});
+        // Every shard produces at every station, only the owner of a station hands its crystals out.
+        if (shard == 0) economy.produced = std::stoull(reply[0]);
+        economy.delivered += std::stoull(reply[1]);
+        economy.stolen += std::stoull(reply[2]);
+    }
+    return economy;
+}
+
+void Shards::stats(size_t kinds[], std::ostream &output) {
+    for (size_t shard = 0; shard < channels.size(); ++shard) {
+        std::vector<std::string> reply = request(shard, {"stats"});
+        for (size_t kind = 0; kind < 4; ++kind) {
+            kinds[kind] += std::stoull(reply[kind]);
+        }
+        output << "Shard " << shard << ":" << std::endl << reply[4];
+    }
+}
+
+std::vector<std::string> Shards::request(size_t shard, const std::vector<std::string> &fields) {
+    channels[shard].send(fields);
+    return channels[shard].receive();
+}
+
+void Shards::forward(size_t shard, const std::vector<std::string> &args, const std::string &agentName, std::ostream &output) {
+    std::vector<std::string> message = {"command", join(args), "", "", ""};
+    Agent *agent = nullptr;
+    try {
+        if (!agentName.empty()) agent = &hub.findAgent(Symbol::intern(agentName));
+    } catch (const std::out_of_range &exception) {
+        // The shard does not know the agent either and reports it missing.
+    }
+    if (agent != nullptr) {
+        message[2] = agentName;
+        message[3] = dynamic_cast<Shipman *>(agent) != nullptr ? "midshipman" : dynamic_cast<Commander *>(agent) != nullptr ? "commander" : "admiral";
+        message[4] = hub.isAssigned(agent->getSymbol()) ? "1" : "0";
+    }
+    std::vector<std::string> reply = request(shard, message);
+    output << reply[0];
+    for (size_t i = 2; i < reply.size(); ++i) {
+        std::istringstream stream(reply[i]);
+        SweepGrid::Sweep path = readPath(stream);
+        hub.addRocket({{path.x, path.y}, {path.toX, path.toY}});
+    }
+    if (!reply[1].empty()) throw std::runtime_error(reply[1].substr(0, reply[1].size() - 1));
+}
+
+void Shards::move(Symbol name, size_t shard) {
+    std::vector<std::string> states = request(owners.at(name), {"extract", name.str()});
+    request(shard, {"insert", states[0]});
+    owners[name] = shard;
+}
+
+void Shards::serve(Channel &channel, const std::string &path, const Strips &strips, size_t index) {
+    std::istringstream input;
+    std::ostringstream output;
+    std::ostringstream errors;
+    output.copyfmt(std::cout);
+    Controller controller(input, output, errors);
+    controller.open(path);
+    Model &model = controller.getModel();
+    while (true) {
+        std::vector<std::string> message;
+        try {
+            message = channel.receive();
+        } catch (const std::runtime_error &exception) {
+            return; // The hub is gone.
+        }
+        const std::string &verb = message[0];
+        std::vector<std::string> reply;
+        if (verb == "exit") {
+            return;
+        } else if (verb == "command") {
+            if (!message[2].empty()) {
+                Symbol agentName = Symbol::intern(message[2]);
+                try {
+                    model.findAgent(agentName);
+                } catch (const std::out_of_range &exception) {
+                    if (message[3] == "midshipman") model.createShipman(agentName);
+                    if (message[3] == "commander") model.createCommander(agentName);
+                    if (message[3] == "admiral") model.createAdmiral(agentName);
+                }
+                model.releaseAgent(agentName);
+                if (message[4] == "1") model.takeAgent(agentName);
+            }
+            controller.execute(message[1]);
+            reply = {output.str(), errors.str()};
+            output.str("");
+            errors.str("");
+            for (const auto &rocket: model.takeRockets()) {
+                Object::Point location = rocket->getLocation();
+                Object::Point destination = rocket->getDestination();
+                reply.push_back(write({location[0], location[1], destination[0], destination[1]}));
+            }
+        } else if (verb == "extract") {
+            for (size_t i = 1; i < message.size(); ++i) {
+                reply.push_back(model.extract(Symbol::intern(message[i])));
+            }
+        } else if (verb == "insert") {
+            model.insert({message.begin() + 1, message.end()});
+        } else if (verb == "migrate") {
+            std::vector<std::pair<Symbol, size_t>> leaving;
+            std::vector<Symbol> bombers;
+            for (const auto &spaceship: model.getSpaceships()) {
+                // A falcon follows its victim, or stays with its wreck, so they meet in the same shard.
+                Object::Point anchor = spaceship->getLocation();
+                if (spaceship->getKind() == Spaceship::FALCON) {
+                    const auto &falcon = static_cast<const Falcon &>(*spaceship);
+                    if (falcon.getVictim() != nullptr) {
+                        anchor = falcon.getVictim()->getLocation();
+                    } else if (falcon.getWreck() != nullptr) {
+                        anchor = falcon.getWreck()->getLocation();
+                    }
+                }
+                size_t strip = strips.of(anchor[0]);
+                if (strip != index) {
+                    leaving.emplace_back(spaceship->getSymbol(), strip);
+                } else if (spaceship->getKind() == Spaceship::BOMBER) {
+                    bombers.push_back(spaceship->getSymbol());
+                }
+            }
+            for (const auto &spaceship: leaving) {
+                Spaceship &leaver = model.findSpaceship(spaceship.first);
+                std::string indices = leaver.getKind() == Spaceship::BOMBER ? copies(strips, spaceship.second, leaver.getLocation()[0], halo) : "";
+                reply.insert(reply.end(), {std::to_string(spaceship.second), indices, model.extract(spaceship.first)});
+            }
+            for (Symbol bomber: bombers) {
+                std::string indices = copies(strips, index, model.findSpaceship(bomber).getLocation()[0], halo);
+                if (!indices.empty()) reply.insert(reply.end(), {"-", indices, model.save(bomber)});
+            }
+        } else if (verb == "tick") {
+            std::istringstream radius(message[1]);
+            double blastRadius = Utilities::readExact(radius);
+            size_t newcomers = std::stoull(message[2]);
+            auto begin = message.begin() + 3;
+            model.insert({begin, begin + (long)newcomers});
+            begin += (long)newcomers;
+            size_t copied = std::stoull(*begin++);
+            std::vector<std::string> copies(begin, begin + (long)copied);
+            model.insert(copies);
+            begin += (long)copied;
+            std::vector<SweepGrid::Sweep> paths;
+            for (; begin != message.end(); ++begin) {
+                std::istringstream stream(*begin);
+                paths.push_back(readPath(stream));
+            }
+            std::vector<std::pair<Spaceship *, Object::Point>> falcons;
+            if (!paths.empty()) {
+                for (const auto &spaceship: model.getSpaceships()) {
+                    if (spaceship->getKind() == Spaceship::FALCON) falcons.emplace_back(spaceship.get(), spaceship->getLocation());
+                }
+            }
+            model.update();
+            for (const std::string &state: copies) {
+                model.remove(nameOf(state));
+            }
+            std::vector<Spaceship *> live;
+            std::vector<SweepGrid::Sweep> flown;
+            for (const auto &falcon: falcons) {
+                if (falcon.first->status() == Spaceship::DEAD) continue;
+                Object::Point location = falcon.first->getLocation();
+                live.push_back(falcon.first);
+                flown.push_back({falcon.second[0], falcon.second[1], location[0], location[1]});
+            }
+            double extent = 0;
+            for (const auto &path: paths) {
+                extent = std::max({extent, std::abs(path.toX - path.x), std::abs(path.toY - path.y)});
+            }
+            // The hub previews the paths of the rockets, which may still snap onto their targets.
+            SweepGrid grid;
+            grid.build(flown, blastRadius + 2 * Coordinate::epsilon + 1, extent + 2 * Coordinate::epsilon + 1);
+            std::vector<bool> near(flown.size(), false);
+            std::vector<uint32_t> candidates;
+            for (const auto &path: paths) {
+                grid.query(path, candidates);
+                for (uint32_t candidate: candidates) {
+                    near[candidate] = true;
+                }
+            }
+            for (size_t i = 0; i < flown.size(); ++i) {
+                if (near[i]) reply.push_back(live[i]->getName() + ' ' + write(flown[i]));
+            }
+        } else if (verb == "kill") {
+            for (size_t i = 1; i < message.size(); ++i) {
+                model.findSpaceship(Symbol::intern(message[i])).die();
+            }
+        } else if (verb == "status") {
+            reply.push_back(std::to_string(model.getSpaceships().size() + model.getWrecks().size()));
+            for (const auto &spaceship: model.getSpaceships()) {
+                std::ostringstream line;
+                line.copyfmt(output);
+                line << *spaceship;
+                reply.insert(reply.end(), {spaceship->getName(), line.str()});
+            }
+            for (const auto &wreck: model.getWrecks()) {
+                std::ostringstream line;
+                line.copyfmt(output);
+                wreck.second.print(line, model);
+                reply.insert(reply.end(), {wreck.first.str(), line.str()});
+            }
+            for (const auto &site: model.getSites()) {
+                if (strips.of(site->getLocation()[0]) != index) continue;
+                std::ostringstream line;
+                line.copyfmt(output);
+                line << *site;
+                reply.insert(reply.end(), {site->getName(), line.str()});
+            }
+        } else if (verb == "query") {
+            Query query(Utilities::split(message[1]), model);
+            Query::Result result = query.match(model, output, [&strips, index](const Site &site) -> bool {
+                return strips.of(site.getLocation()[0]) == index;
+            });
+            reply.push_back(std::to_string(result.total));
+            for (const auto &line: result.lines) {
+                reply.insert(reply.end(), {line.first, line.second});
+            }
+        } else if (verb == "economy") {
+            const Model::Economy &economy = model.getEconomy();
+            reply = {std::to_string(economy.produced), std::to_string(economy.delivered), std::to_string(economy.stolen)};
+        } else if (verb == "stats") {
+            size_t kinds[4] = {0, 0, 0, 0};
+            for (const auto &spaceship: model.getSpaceships()) {
+                ++kinds[spaceship->getKind()];
+            }
+            for (const auto &wreck: model.getWrecks()) {
+                ++kinds[wreck.second.getKind()];
+            }
+            std::ostringstream profile;
+            profile.copyfmt(output);
+            model.getProfiler().print(profile);
+            reply = {std::to_string(kinds[0]), std::to_string(kinds[1]), std::to_string(kinds[2]), std::to_string(kinds[3]), profile.str()};
+        } else {
+            throw std::invalid_argument("Unknown request " + verb + ".");
+        }
+        channel.send(reply);
+    }
+}
@@ -1,6 +1,7 @@
 #include "Site.h"
+#include "Model.h"
 
-Site::Site(const std::string &name, size_t count, const Point &location) : Object(name, location), crystals(count) {
+Site::Site(Symbol name, size_t count, const Point &location) : Object(name, location), crystals(count), handle() {
 
 }
 
@@ -21,28 +22,57 @@ size_t Site::removeCrystals(size_t count) {
 
 void Site::print(std::ostream &stream) const {
     Object::print(stream);
-    stream << " containing " << crystals << " crystals.";
+    stream << " containing " << getCrystals() << " crystals.";
 }
 
 size_t Site::getCrystals() const {
     return crystals;
 }
 
+Handle<Site> Site::getHandle() const {
+    return handle;
+}
+
+void Site::setHandle(const Handle<Site> &h) {
+    handle = h;
+}
+
 void Site::printType(std::ostream &stream) const {
     stream << "Site";
 }
 
 Site::~Site() = default;
 
-SpaceStation::SpaceStation(const std::string &name, const Point &location, size_t count, size_t productionRate) :
+SpaceStation::SpaceStation(const Model &world, Symbol name, const Point &location, size_t count, size_t productionRate) :
     Site(name, count, location),
-    productionRate(productionRate)
+    world(world),
+    productionRate(productionRate),
+    since(world.getTime())
 {
 
 }
 
 void SpaceStation::update() {
-    addCrystals(productionRate);
+
+}
+
+void SpaceStation::addCrystals(size_t count) {
+    settle();
+    Site::addCrystals(count);
+}
+
+size_t SpaceStation::removeCrystals(size_t count) {
+    settle();
+    return Site::removeCrystals(count);
+}
+
+size_t SpaceStation::getCrystals() const {
+    return Site::getCrystals() + productionRate * (world.getTime() - since);
+}
+
+void SpaceStation::settle() {
+    Site::addCrystals(productionRate * (world.getTime() - since));
+    since = world.getTime();
 }
 
 void SpaceStation::print(std::ostream &stream) const {
@@ -54,7 +84,11 @@ void SpaceStation::printType(std::ostream &stream) const {
     stream << "Space Station";
 }
 
-FortressStar::FortressStar(const std::string &name, const Point &location, size_t count) :
+size_t SpaceStation::getProductionRate() const {
+    return productionRate;
+}
+
+FortressStar::FortressStar(Symbol name, const Point &location, size_t count) :
     Site(name, count, location)
 {
 
@@ -0,0 +1,243 @@
+#include "SiteIndex.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+SiteIndex::Visited::Visited(size_t size) : bits((size + 63) / 64), size(size), counts() {
+
+}
+
+SiteIndex::Visited::Visited(const SiteIndex &index, size_t size) : bits((size + 63) / 64), size(size), counts(std::make_unique<Counts>()) {
+    counts->positions = index.layout();
+    counts->unvisited.assign(counts->positions->size(), 0);
+    for (size_t id = 0; id < size && id < counts->positions->size(); ++id) {
+        count(id, false);
+    }
+}
+
+bool SiteIndex::Visited::contains(size_t id) const {
+    if (id >= size) return true;
+    return (bits[id / 64] >> (id % 64)) & 1;
+}
+
+void SiteIndex::Visited::insert(size_t id) {
+    if (contains(id)) return;
+    bits[id / 64] |= (uint64_t)1 << (id % 64);
+    if (counts != nullptr && id < counts->positions->size()) count(id, true);
+}
+
+size_t SiteIndex::Visited::getSize() const {
+    return size;
+}
+
+void SiteIndex::Visited::count(size_t id, bool visit) {
+    size_t position = (*counts->positions)[id];
+    size_t begin = 0;
+    size_t end = counts->positions->size();
+    while (true) {
+        size_t middle = begin + (end - begin) / 2;
+        if (visit) {
+            --counts->unvisited[middle];
+        } else {
+            ++counts->unvisited[middle];
+        }
+        if (position == middle) return;
+        if (position < middle) {
+            end = middle;
+        } else {
+            begin = middle + 1;
+        }
+    }
+}
+
+SiteIndex::Visited SiteIndex::Tour::visited(const SiteIndex &index, size_t legs) const {
+    Visited result(index, sites);
+    result.insert(start);
+    for (size_t i = 0; i < legs && i < order.size(); ++i) {
+        result.insert(order[i]);
+    }
+    return result;
+}
+
+SiteIndex::SiteIndex() : sites(), ids(), tree(), positions(), tours(), dirty(false) {
+
+}
+
+void SiteIndex::add(const std::shared_ptr<Site> &site) {
+    ids.emplace(site.get(), sites.size());
+    sites.push_back(site);
+    tours.clear();
+    dirty = true;
+}
+
+size_t SiteIndex::size() const {
+    return sites.size();
+}
+
+const std::shared_ptr<Site> &SiteIndex::get(size_t id) const {
+    return sites.at(id);
+}
+
+size_t SiteIndex::find(const Site &site) const {
+    auto iterator = ids.find(&site);
+    if (iterator == ids.end()) throw std::out_of_range(site.getName() + " is not an indexed site.");
+    return iterator->second;
+}
+
+size_t SiteIndex::nearest(const Object::Point &point, const Visited &visited) const {
+    build();
+    double coordinates[2] = {point[0], point[1]};
+    double best = std::numeric_limits<double>::infinity();
+    size_t closest = sites.size();
+    search(0, tree.size(), 0, coordinates, visited, best, closest);
+    return closest;
+}
+
+std::vector<size_t> SiteIndex::nearest(const Object::Point &point, size_t count, const Visited &visited) const {
+    build();
+    double coordinates[2] = {point[0], point[1]};
+    std::vector<std::pair<double, size_t>> closest;
+    closest.reserve(count + 1);
+    if (count != 0) search(0, tree.size(), 0, coordinates, visited, count, closest);
+    std::sort_heap(closest.begin(), closest.end());
+    std::vector<size_t> result;
+    result.reserve(closest.size());
+    for (const auto &pair: closest) {
+        result.push_back(pair.second);
+    }
+    return result;
+}
+
+size_t SiteIndex::at(const Object::Point &point, const Visited &visited) const {
+    build();
+    double coordinates[2] = {point[0], point[1]};
+    double best = 0;
+    size_t closest = sites.size();
+    search(0, tree.size(), 0, coordinates, visited, best, closest);
+    return closest;
+}
+
+std::vector<size_t> SiteIndex::within(const Object::Point &point, double radius) const {
+    build();
+    double coordinates[2] = {point[0], point[1]};
+    std::vector<size_t> found;
+    collect(0, tree.size(), 0, coordinates, radius, found);
+    return found;
+}
+
+std::shared_ptr<const SiteIndex::Tour> SiteIndex::tour(size_t start) const {
+    auto iterator = tours.find(start);
+    if (iterator != tours.end()) return iterator->second;
+    std::shared_ptr<Tour> tour = std::make_shared<Tour>();
+    tour->start = start;
+    tour->sites = sites.size();
+    Visited visited = tour->visited(*this, 0);
+    size_t current = start;
+    for (size_t closest = nearest(get(current)->getLocation(), visited); closest != sites.size(); closest = nearest(get(current)->getLocation(), visited)) {
+        tour->order.push_back((uint32_t)closest);
+        visited.insert(closest);
+        current = closest;
+    }
+    tours.emplace(start, tour);
+    return tour;
+}
+
+void SiteIndex::build() const {
+    if (!dirty) return;
+    tree.resize(sites.size());
+    for (size_t i = 0; i < sites.size(); ++i) {
+        Object::Point location = sites[i]->getLocation();
+        tree[i] = {{location[0], location[1]}, (uint32_t)i};
+    }
+    build(0, tree.size(), 0);
+    auto layout = std::make_shared<std::vector<uint32_t>>(tree.size());
+    for (size_t i = 0; i < tree.size(); ++i) {
+        (*layout)[tree[i].id] = (uint32_t)i;
+    }
+    positions = layout;
+    dirty = false;
+}
+
+void SiteIndex::build(size_t begin, size_t end, size_t axis) const {
+    if (end - begin <= 1) return;
+    size_t middle = begin + (end - begin) / 2;
+    std::nth_element(tree.begin() + (long)begin, tree.begin() + (long)middle, tree.begin() + (long)end, [axis](const Node &a, const Node &b) -> bool {
+        return a.coordinates[axis] < b.coordinates[axis];
+    });
+    build(begin, middle, 1 - axis);
+    build(middle + 1, end, 1 - axis);
+}
+
+std::shared_ptr<const std::vector<uint32_t>> SiteIndex::layout() const {
+    build();
+    return positions;
+}
+
+bool SiteIndex::exhausted(const Visited &visited, size_t middle) const {
+    return visited.counts != nullptr && visited.counts->positions == positions && visited.counts->unvisited[middle] == 0;
+}
+
+void SiteIndex::search(size_t begin, size_t end, size_t axis, const double *point, const Visited &visited, double &best, size_t &closest) const {
+    if (begin >= end) return;
+    size_t middle = begin + (end - begin) / 2;
+    if (exhausted(visited, middle)) return;
+    const Node &node = tree[middle];
+    if (!visited.contains(node.id)) {
+        double dx = node.coordinates[0] - point[0];
+        double dy = node.coordinates[1] - point[1];
+        double distance = dx * dx + dy * dy;
+        if (distance < best || (distance == best && node.id < closest)) {
+            best = distance;
+            closest = node.id;
+        }
+    }
+    double difference = point[axis] - node.coordinates[axis];
+    if (difference < 0) {
+        search(begin, middle, 1 - axis, point, visited, best, closest);
+        if (difference * difference <= best) search(middle + 1, end, 1 - axis, point, visited, best, closest);
+    } else {
+        search(middle + 1, end, 1 - axis, point, visited, best, closest);
+        if (difference * difference <= best) search(begin, middle, 1 - axis, point, visited, best, closest);
+    }
+}
+
+void SiteIndex::search(size_t begin, size_t end, size_t axis, const double *point, const Visited &visited, size_t count, std::vector<std::pair<double, size_t>> &closest) const {
+    if (begin >= end) return;
+    size_t middle = begin + (end - begin) / 2;
+    if (exhausted(visited, middle)) return;
+    const Node &node = tree[middle];
+    if (!visited.contains(node.id)) {
+        double dx = node.coordinates[0] - point[0];
+        double dy = node.coordinates[1] - point[1];
+        std::pair<double, size_t> candidate = {dx * dx + dy * dy, node.id};
+        if (closest.size() < count) {
+            closest.push_back(candidate);
+            std::push_heap(closest.begin(), closest.end());
+        } else if (candidate < closest.front()) {
+            std::pop_heap(closest.begin(), closest.end());
+            closest.back() = candidate;
+            std::push_heap(closest.begin(), closest.end());
+        }
+    }
+    double difference = point[axis] - node.coordinates[axis];
+    size_t first = difference < 0 ? begin : middle + 1;
+    size_t firstEnd = difference < 0 ? middle : end;
+    size_t second = difference < 0 ? middle + 1 : begin;
+    size_t secondEnd = difference < 0 ? end : middle;
+    search(first, firstEnd, 1 - axis, point, visited, count, closest);
+    if (closest.size() < count || difference * difference <= closest.front().first) {
+        search(second, secondEnd, 1 - axis, point, visited, count, closest);
+    }
+}
+
+void SiteIndex::collect(size_t begin, size_t end, size_t axis, const double *point, double radius, std::vector<size_t> &found) const {
+    if (begin >= end) return;
+    size_t middle = begin + (end - begin) / 2;
+    const Node &node = tree[middle];
+    double dx = node.coordinates[0] - point[0];
+    double dy = node.coordinates[1] - point[1];
+    if (dx * dx + dy * dy <= radius * radius) found.push_back(node.id);
+    double difference = point[axis] - node.coordinates[axis];
+    if (difference - radius <= 0) collect(begin, middle, 1 - axis, point, radius, found);
+    if (difference + radius >= 0) collect(middle + 1, end, 1 - axis, point, radius, found);
+}
@@ -1,35 +1,46 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <istream>
 #include "Model.h"
 #include "Spaceship.h"
 
-Spaceship::Spaceship(const std::string &name, const std::shared_ptr<Agent> &agent, double speed, size_t health, const Point &location) :
+Spaceship::Spaceship(Model &world, Symbol name, Kind kind, const Handle<Agent> &agent, double speed, size_t health, const Point &location) :
     MovingObject(name, speed, location),
+    world(world),
+    handle(),
     agent(agent),
-    health(health),
-    crystals(0)
+    site(),
+    heading(),
+    angle(0),
+    health((uint8_t)health),
+    crystals(0),
+    onCourse(false),
+    awake(true),
+    kind(kind)
 {
 
 }
 Spaceship::Status Spaceship::status() const {
     if (health == 0) return DEAD;
     if (getLocation() != getDestination()) return MOVING;
-    if (site != nullptr && getLocation() == site->getLocation()) return DOCKED;
+    Site *s = world.resolve(site);
+    if (s != nullptr && getLocation() == s->getLocation()) return DOCKED;
     return Spaceship::STOPPED;
 }
 void Spaceship::print(std::ostream &stream) const {
     MovingObject::print(stream);
+    Site *s = world.resolve(site);
     if (status() == DEAD) {
         stream << " is dead.";
-    } else if (status() == MOVING && site != nullptr) {
-        stream << " moving towards " << site->getName() << ".";
-    } else if (status() == MOVING && angle != nullptr) {
-        stream << " moving on course " << *angle * 180 / M_PI << ".";
+    } else if (status() == MOVING && s != nullptr) {
+        stream << " moving towards " << s->getName() << ".";
+    } else if (status() == MOVING && onCourse) {
+        stream << " moving on course " << angle * 180 / M_PI << ".";
     } else if (status() == DOCKED) {
-        stream << " docked at " << site->getName() << ".";
+        stream << " docked at " << s->getName() << ".";
     }
-    if (agent != nullptr) {
-        stream << " is driven by " << *agent << ".";
+    if (getAgent() != nullptr) {
+        stream << " is driven by " << *getAgent() << ".";
     }
 }
 void Spaceship::printType(std::ostream &stream) const {
@@ -38,24 +49,29 @@ void Spaceship::printType(std::ostream &stream) const {
 size_t Spaceship::getHealth() const {
     return health;
 }
+Spaceship::Kind Spaceship::getKind() const {
+    return kind;
+}
 size_t Spaceship::getCrystals() const {
     return crystals;
 }
 void Spaceship::go(const Object::Point &point) {
     if (status() == DEAD) throw std::runtime_error(getName() + " is dead and cannot operate.");
-    site = nullptr;
-    angle = nullptr;
+    site = {};
+    onCourse = false;
     MovingObject::go(point);
+    wake();
 }
-void Spaceship::goTo(const std::shared_ptr<Site> &s) {
-    site = s;
-    angle = nullptr;
-    MovingObject::go(site->getLocation());
+void Spaceship::goTo(Site &s) {
+    site = s.getHandle();
+    onCourse = false;
+    MovingObject::go(s.getLocation());
+    wake();
 }
 void Spaceship::stop() {
     MovingObject::go(this->getLocation());
-    site = nullptr;
-    angle = nullptr;
+    site = {};
+    onCourse = false;
 }
 void Spaceship::hurt() {
     if (health == 0) return;
@@ -68,40 +84,86 @@ void Spaceship::heal() {
     ++health;
 }
 void Spaceship::die() {
+    Tracer::instant("death", getSymbol());
     health = 0;
     stop();
+    world.recordDeath(*this);
+}
+size_t Spaceship::add(size_t count) {
+    count = std::min(count, crystalsToTake());
+    crystals += (uint8_t)count;
+    return count;
 }
-void Spaceship::add() {
-    if (crystals >= maxCrystals) return;
-    ++crystals;
+size_t Spaceship::remove(size_t count) {
+    count = std::min(count, (size_t)crystals);
+    crystals -= (uint8_t)count;
+    return count;
 }
-void Spaceship::remove() {
-    if (crystals == 0) return;
-    --crystals;
+size_t Spaceship::load(Site &from, size_t count) {
+    return add(from.removeCrystals(std::min(count, crystalsToTake())));
+}
+size_t Spaceship::unload(Site &to, size_t count) {
+    count = remove(count);
+    to.addCrystals(count);
+    return count;
 }
 void Spaceship::course(double a) {
     a = fmod(a, 360);
     a *= M_PI / 180;
-    angle = std::make_shared<double>(a);
-    Point direction = {(getSpeed() + 1) * std::sin(*angle), (getSpeed() + 1) * std::cos(*angle)};
+    angle = a;
+    heading = {std::sin(a), std::cos(a)};
+    onCourse = true;
+    Point direction = {(getSpeed() + 1) * heading[0], (getSpeed() + 1) * heading[1]};
     MovingObject::go(direction + getLocation());
-    site = nullptr;
+    site = {};
+    wake();
 }
 void Spaceship::shoot(const Object::Point &point) {
     throw std::runtime_error(getName() + " is not a destroyer and cannot shoot a rocket to " + point.toString());
 }
-void Spaceship::transport(const std::shared_ptr<SpaceStation> &station, const std::shared_ptr<FortressStar> &star) {
-    throw std::runtime_error(getName() + " is not a shuttle and cannot transport crystals from " + station->getName() + " to " + star->getName());
+void Spaceship::transport(SpaceStation &station, FortressStar &star) {
+    throw std::runtime_error(getName() + " is not a shuttle and cannot transport crystals from " + station.getName() + " to " + star.getName());
+}
+void Spaceship::attack(Spaceship &victim) {
+    throw std::runtime_error(getName() + " is not a falcon and cannot attack " + victim.getName());
 }
-void Spaceship::attack(const std::shared_ptr<Spaceship> &victim) {
-    throw std::runtime_error(getName() + " is not a falcon and cannot attack " + victim->getName());
+void Spaceship::attack(const Wreck &victim) {
+    throw std::runtime_error(getName() + " is not a falcon and cannot attack " + victim.getSymbol().str());
 }
-void Spaceship::beAttacked(const std::shared_ptr<Spaceship> &attacker) {
-    throw std::runtime_error(getName() + " is not a shuttle and cannot be attacked by " + attacker->getName());
+void Spaceship::beAttacked(Spaceship &attacker) {
+    throw std::runtime_error(getName() + " is not a shuttle and cannot be attacked by " + attacker.getName());
 }
 size_t Spaceship::crystalsToTake() const {
     return maxCrystals - crystals;
 }
+void Spaceship::save(std::ostream &stream) const {
+    for (double value: {getLocation()[0], getLocation()[1], getDestination()[0], getDestination()[1], getSpeed(), heading[0], heading[1], angle}) {
+        Utilities::writeExact(stream, value);
+    }
+    Site *s = world.resolve(site);
+    stream << (size_t)health << ' ' << (size_t)crystals << ' ' << onCourse << ' ' << (s != nullptr ? s->getName() : "-") << ' ';
+}
+void Spaceship::restore(std::istream &stream) {
+    double values[8];
+    for (double &value: values) {
+        value = Utilities::readExact(stream);
+    }
+    setLocation({values[0], values[1]});
+    MovingObject::go({values[2], values[3]});
+    setSpeed(values[4]);
+    heading = {values[5], values[6]};
+    angle = values[7];
+    size_t h;
+    size_t c;
+    bool course;
+    std::string siteName;
+    stream >> h >> c >> course >> siteName;
+    onCourse = course;
+    health = (uint8_t)h;
+    crystals = (uint8_t)c;
+    site = siteName == "-" ? Handle<Site>() : world.findSite(Symbol::intern(siteName)).getHandle();
+    wake();
+}
 void Spaceship::course(double a, double speed) {
     throw std::runtime_error(getName() + " is not a falcon and cannot change angle to " + std::to_string(a) + " speed to " + std::to_string(speed));
 }
@@ -109,67 +171,120 @@ void Spaceship::go(const Object::Point &point, double speed) {
     throw std::invalid_argument(getName() + " is not a falcon and cannot go to " + point.toString() + " change speed to " + std::to_string(speed));
 }
 void Spaceship::update() {
-    if (angle != nullptr) {
-        Point direction = {(getSpeed() + 1) * std::sin(*angle), (getSpeed() + 1) * std::cos(*angle)};
+    if (onCourse) {
+        Point direction = {(getSpeed() + 1) * heading[0], (getSpeed() + 1) * heading[1]};
         MovingObject::go(direction + getLocation());
     }
     MovingObject::update();
 }
-const std::shared_ptr<Agent> &Spaceship::getAgent() const {
-    return agent;
+bool Spaceship::isSteady() const {
+    return !onCourse && getLocation() == getDestination();
 }
-void Spaceship::interact(const std::shared_ptr<SpaceStation> &station) {
-    std::cout << getName() + " docked at " + station->getName() << std::endl;
+void Spaceship::sleep() {
+    awake = false;
 }
-void Spaceship::interact(const std::shared_ptr<FortressStar> &star) {
-    std::cout << getName() + " docked at " + star->getName() << std::endl;
+void Spaceship::wake() {
+    if (awake) return;
+    awake = true;
+    world.wake(*this);
+}
+Agent *Spaceship::getAgent() const {
+    return world.resolve(agent);
+}
+Handle<Spaceship> Spaceship::getHandle() const {
+    return handle;
+}
+void Spaceship::setHandle(const Handle<Spaceship> &h) {
+    handle = h;
+}
+Model &Spaceship::getWorld() const {
+    return world;
+}
+void Spaceship::interact(SpaceStation &station) {
+    std::cout << getName() + " docked at " + station.getName() << std::endl;
+}
+void Spaceship::interact(FortressStar &star) {
+    std::cout << getName() + " docked at " + star.getName() << std::endl;
 }
 
-Shuttle::Shuttle(const std::string &name, const std::string &agentName, const Point &location) :
-    Spaceship(name, Model::get().findAgent(agentName), speed, startHealth, location),
+Shuttle::Shuttle(Model &world, Symbol name, Symbol agentName, const Point &location) :
+    Spaceship(world, name, SHUTTLE, world.findAgent(agentName).getHandle(), speed, startHealth, location),
     jobs()
 {
-    if (!std::dynamic_pointer_cast<Shipman>(getAgent())) throw std::runtime_error(getName() + " is a shuttle and can only have a midshipman as an agent");
-    Model::get().takeAgent(agentName);
+    if (dynamic_cast<Shipman *>(getAgent()) == nullptr) throw std::runtime_error(getName() + " is a shuttle and can only have a midshipman as an agent");
+    getWorld().takeAgent(agentName);
 }
 void Shuttle::update() {
     if (!jobs.empty()) {
         Job &job = jobs.front();
-        std::shared_ptr<SpaceStation> &from = job.first;
-        std::shared_ptr<FortressStar> &to = job.second;
-        if (from != nullptr && from->getLocation() == getLocation()) {
-            interact(from);
-            from = nullptr;
+        auto *from = static_cast<SpaceStation *>(getWorld().resolve(job.first));
+        auto *to = static_cast<FortressStar *>(getWorld().resolve(job.second));
+        if (to == nullptr) {
+            jobs.erase(jobs.begin());
+            getWorld().releaseStation(*this);
+        } else if (from != nullptr && from->getLocation() == getLocation()) {
+            interact(*from);
+            job.first = {};
+            getWorld().releaseStation(*this);
         } else if (from != nullptr) {
-            Spaceship::goTo(from);
+            Spaceship::goTo(*from);
         } else if (to->getLocation() == getLocation()) {
-            interact(to);
-            jobs.pop();
+            interact(*to);
+            jobs.erase(jobs.begin());
+            getWorld().releaseStation(*this);
         } else {
-            Spaceship::goTo(to);
+            Spaceship::goTo(*to);
         }
     }
     Spaceship::update();
 }
-void Shuttle::transport(const std::shared_ptr<SpaceStation> &station, const std::shared_ptr<FortressStar> &star) {
+void Shuttle::transport(SpaceStation &station, FortressStar &star) {
     if (status() == DEAD) throw std::runtime_error(getName() + " is dead and cannot operate.");
-    jobs.emplace(station, star);
-}
-void Shuttle::interact(const std::shared_ptr<SpaceStation> &station) {
-    while (crystalsToTake() != 0 && station->removeCrystals(1)) {
-        add();
+    jobs.emplace_back(station.getHandle(), star.getHandle());
+    wake();
+}
+bool Shuttle::isSteady() const {
+    return jobs.empty() && Spaceship::isSteady();
+}
+bool Shuttle::isIdle() const {
+    return jobs.empty() && status() != DEAD && status() != MOVING;
+}
+void Shuttle::save(std::ostream &stream) const {
+    Spaceship::save(stream);
+    stream << jobs.size() << ' ';
+    for (const Job &job: jobs) {
+        Site *from = getWorld().resolve(job.first);
+        Site *to = getWorld().resolve(job.second);
+        stream << (from != nullptr ? from->getName() : "-") << ' ' << (to != nullptr ? to->getName() : "-") << ' ';
     }
 }
-void Shuttle::interact(const std::shared_ptr<FortressStar> &star) {
-    while (getCrystals() != 0) {
-        remove();
-        star->addCrystals(1);
+void Shuttle::restore(std::istream &stream) {
+    Spaceship::restore(stream);
+    size_t count;
+    stream >> count;
+    jobs.clear();
+    for (size_t i = 0; i < count; ++i) {
+        std::string from;
+        std::string to;
+        stream >> from >> to;
+        jobs.emplace_back(from == "-" ? Handle<Site>() : getWorld().findSite(Symbol::intern(from)).getHandle(),
+                          to == "-" ? Handle<Site>() : getWorld().findSite(Symbol::intern(to)).getHandle());
     }
+}
+void Shuttle::interact(SpaceStation &station) {
+    Tracer::instant("dock", getSymbol(), station.getSymbol());
+    load(station, crystalsToTake());
+}
+void Shuttle::interact(FortressStar &star) {
+    Tracer::instant("dock", getSymbol(), star.getSymbol());
+    getWorld().recordDelivery(unload(star, getCrystals()));
     heal();
 }
 void Shuttle::stop() {
     Spaceship::stop();
-    jobs = {};
+    if (jobs.empty()) return;
+    jobs.clear();
+    getWorld().releaseStation(*this);
 }
 void Shuttle::course(double angle) {
     throw std::runtime_error("Shuttle cannot change angle to " + std::to_string(angle));
@@ -184,33 +299,30 @@ void Shuttle::printType(std::ostream &stream) const {
 void Shuttle::go(const Object::Point &point) {
     throw std::runtime_error(getName() + " is a shuttle and cannot go to " + point.toString());
 }
-void Shuttle::goTo(const std::shared_ptr<Site> &site) {
-    throw std::runtime_error(getName() + " is a shuttle and cannot go to " + site->getName());
+void Shuttle::goTo(Site &site) {
+    throw std::runtime_error(getName() + " is a shuttle and cannot go to " + site.getName());
 }
-void Shuttle::beAttacked(const std::shared_ptr<Spaceship> &attacker) {
+void Shuttle::beAttacked(Spaceship &attacker) {
+    wake();
     hurt();
-    if (attacker->getLocation().distance(getLocation()) <= 100 && getHealth() < attacker->getHealth() && !Model::get().isBomberNearby(getLocation())) {
-        attacker->heal();
-        while (getCrystals() != 0) {
-            remove();
-            attacker->add();
-        }
+    if (attacker.getLocation().distance(getLocation()) <= 100 && getHealth() < attacker.getHealth() && !getWorld().isBomberNearby(getLocation())) {
+        attacker.heal();
+        getWorld().recordTheft(attacker.add(remove(getCrystals())));
         stop();
     } else {
-        attacker->hurt();
+        attacker.hurt();
     }
 }
 
-Bomber::Bomber(const std::string &name, const std::string &agentName, const std::shared_ptr<Site> &start) :
-    Spaceship(name, Model::get().findAgent(agentName), speed, 1, start->getLocation()),
-    start(start),
-    sites()
+Bomber::Bomber(Model &world, Symbol name, Symbol agentName, Site &start) :
+    Spaceship(world, name, BOMBER, world.findAgent(agentName).getHandle(), speed, 1, start.getLocation()),
+    start(start.getHandle()),
+    leg(0),
+    tour(world.getSiteIndex().tour(world.getSiteIndex().find(start))),
+    visited()
 {
-    std::copy_if(Model::get().getSites().begin(), Model::get().getSites().end(), std::inserter(sites, sites.begin()), [&start](const std::shared_ptr<Site> &site) -> bool {
-        return site != start;
-    });
-    if (!std::dynamic_pointer_cast<Commander>(getAgent())) throw std::runtime_error(getName() + " is a bomber and can only have a commander as an agent");
-    Model::get().takeAgent(agentName);
+    if (dynamic_cast<Commander *>(getAgent()) == nullptr) throw std::runtime_error(getName() + " is a bomber and can only have a commander as an agent");
+    getWorld().takeAgent(agentName);
 }
 void Bomber::print(std::ostream &stream) const {
     Spaceship::print(stream);
@@ -220,36 +332,99 @@ void Bomber::printType(std::ostream &stream) const {
 }
 void Bomber::update() {
     Spaceship::update();
-    for (const auto &site: sites) {
-        if (site->getLocation() == getLocation()) {
-            sites.erase(site);
-            goTo(next());
+    const SiteIndex &index = getWorld().getSiteIndex();
+    if (tour != nullptr) {
+        if (leg < tour->order.size() && index.get(tour->order[leg])->getLocation() == getLocation()) {
+            ++leg;
+            Spaceship::goTo(next());
+            return;
+        }
+    } else {
+        size_t site = index.at(getLocation(), visited);
+        if (site != index.size()) {
+            visited.insert(site);
+            Spaceship::goTo(next());
             return;
         }
     }
-    if (start->getLocation() == getLocation()) {
-        goTo(next());
+    if (getWorld().resolve(start)->getLocation() == getLocation()) {
+        Spaceship::goTo(next());
     }
 }
-const std::shared_ptr<Site> &Bomber::next() const {
-    if (sites.empty()) return start;
-    auto closest = sites.begin();
-    for (auto site = sites.begin(); site != sites.end(); ++site) {
-        if (((*site)->getLocation() - getLocation()).norm() < ((*closest)->getLocation() - getLocation()).norm()) {
-            closest = site;
-        }
+bool Bomber::isSteady() const {
+    return Spaceship::isSteady() && !isAtStop();
+}
+bool Bomber::isAtStop() const {
+    const SiteIndex &index = getWorld().getSiteIndex();
+    if (tour != nullptr) {
+        if (leg < tour->order.size() && index.get(tour->order[leg])->getLocation() == getLocation()) return true;
+    } else if (index.at(getLocation(), visited) != index.size()) {
+        return true;
+    }
+    return getWorld().resolve(start)->getLocation() == getLocation();
+}
+Site &Bomber::next() const {
+    const SiteIndex &index = getWorld().getSiteIndex();
+    if (tour != nullptr) {
+        if (leg == tour->order.size()) return *getWorld().resolve(start);
+        return *index.get(tour->order[leg]);
     }
-    return *closest;
+    size_t closest = index.nearest(getLocation(), visited);
+    if (closest == index.size()) return *getWorld().resolve(start);
+    return *index.get(closest);
+}
+void Bomber::leaveTour() {
+    if (tour == nullptr) return;
+    visited = tour->visited(getWorld().getSiteIndex(), leg);
+    tour = nullptr;
+}
+void Bomber::go(const Object::Point &point) {
+    leaveTour();
+    Spaceship::go(point);
+}
+void Bomber::goTo(Site &site) {
+    leaveTour();
+    Spaceship::goTo(site);
+}
+void Bomber::stop() {
+    leaveTour();
+    Spaceship::stop();
+}
+void Bomber::course(double angle) {
+    leaveTour();
+    Spaceship::course(angle);
+}
+void Bomber::save(std::ostream &stream) const {
+    Spaceship::save(stream);
+    stream << leg << ' ' << (tour != nullptr) << ' ' << visited.getSize() << ' ';
+    for (size_t id = 0; id < visited.getSize(); ++id) {
+        if (visited.contains(id)) stream << id << ' ';
+    }
+    stream << visited.getSize() << ' ';
+}
+void Bomber::restore(std::istream &stream) {
+    Spaceship::restore(stream);
+    bool onTour;
+    size_t size;
+    stream >> leg >> onTour >> size;
+    if (!onTour) tour = nullptr;
+    visited = SiteIndex::Visited(getWorld().getSiteIndex(), size);
+    for (size_t id; stream >> id && id != size;) {
+        visited.insert(id);
+    }
+}
+Site &Bomber::getStart() const {
+    return *getWorld().resolve(start);
 }
 
-Destroyer::Destroyer(const std::string &name, const std::string &agentName, const Object::Point &location) :
-    Spaceship(name, Model::get().findAgent(agentName), speed, 1, location)
+Destroyer::Destroyer(Model &world, Symbol name, Symbol agentName, const Object::Point &location) :
+    Spaceship(world, name, DESTROYER, world.findAgent(agentName).getHandle(), speed, 1, location)
 {
-    if (!std::dynamic_pointer_cast<Admiral>(getAgent())) throw std::runtime_error(getName() + " is a destroyer and can only have an admiral as an agent");
-    Model::get().takeAgent(agentName);
+    if (dynamic_cast<Admiral *>(getAgent()) == nullptr) throw std::runtime_error(getName() + " is a destroyer and can only have an admiral as an agent");
+    getWorld().takeAgent(agentName);
 }
 void Destroyer::shoot(const Object::Point &point) {
-    Model::get().addRocket({getLocation(), point});
+    getWorld().addRocket({getLocation(), point});
 }
 void Destroyer::update() {
     Spaceship::update();
@@ -261,42 +436,55 @@ void Destroyer::printType(std::ostream &stream) const {
     stream << "Destroyer";
 }
 
-Destroyer::Rocket::Rocket(const Point &start, const Point &finish) : MovingObject("* ", 3000, start) {
+Destroyer::Rocket::Rocket(const Point &start, const Point &finish) : MovingObject(symbol(), 3000, start) {
     MovingObject::go(finish);
 }
-void Destroyer::Rocket::update() {
-    MovingObject::update();
-    if (getLocation() == getDestination()) {
-        Model::get().explode(*this);
-    }
+Symbol Destroyer::Rocket::symbol() {
+    static const Symbol rocket = Symbol::intern("* ");
+    return rocket;
 }
 void Destroyer::Rocket::print(std::ostream &stream) const {
-    stream << "Rocket at position " << getLocation() << ". moving to " << getDestination() << " flying " << getSpeed() << " km/h.";
+    stream << "Rocket at position " << getLocation() / Model::scale << ". moving to " << getDestination() / Model::scale << " flying " << getSpeed() << " km/h.";
 }
 
-void Falcon::interact(const std::shared_ptr<SpaceStation> &station) {
-    throw std::runtime_error("Falcon cannot interact with the station " + station->getName());
+void Falcon::interact(SpaceStation &station) {
+    throw std::runtime_error("Falcon cannot interact with the station " + station.getName());
 }
-void Falcon::interact(const std::shared_ptr<FortressStar> &star) {
-    throw std::runtime_error("Falcon cannot interact with the star " + star->getName());
+void Falcon::interact(FortressStar &star) {
+    throw std::runtime_error("Falcon cannot interact with the star " + star.getName());
 }
-Falcon::Falcon(const std::string &name, const Object::Point &location) :
-    Spaceship(name, nullptr, startSpeed, startHealth, location),
-    victim(nullptr)
+Falcon::Falcon(Model &world, Symbol name, const Object::Point &location) :
+    Spaceship(world, name, FALCON, {}, startSpeed, startHealth, location),
+    victim(),
+    wreck()
 {
 
 }
 void Falcon::update() {
-    if (victim != nullptr) {
-        Spaceship::go(victim->getLocation());
+    Spaceship *target = getWorld().resolve(victim);
+    Wreck *remains = getWreck();
+    if (target != nullptr) {
+        Spaceship::go(target->getLocation());
+    } else if (remains != nullptr) {
+        Spaceship::go(remains->getLocation());
     }
     Spaceship::update();
-    if (victim != nullptr) {
-        victim->beAttacked(Model::get().findSpaceship(getName()));
-        victim = nullptr;
+    if (target != nullptr) {
+        Tracer::instant("attack", getSymbol(), target->getSymbol());
+        target->beAttacked(*this);
+    } else if (remains != nullptr) {
+        Tracer::instant("attack", getSymbol(), remains->getSymbol());
+        remains->beAttacked(*this, getWorld());
+    }
+    if (target != nullptr || remains != nullptr) {
+        victim = {};
+        wreck = {};
         stop();
     }
 }
+bool Falcon::isSteady() const {
+    return victim == Handle<Spaceship>() && wreck == Symbol() && Spaceship::isSteady();
+}
 void Falcon::print(std::ostream &stream) const {
     Spaceship::print(stream);
     stream << " holding " << getCrystals() << " crystals with " << getHealth() << " health.";
@@ -304,9 +492,17 @@ void Falcon::print(std::ostream &stream) const {
 void Falcon::printType(std::ostream &stream) const {
     stream << "Falcon";
 }
-void Falcon::attack(const std::shared_ptr<Spaceship> &spaceship) {
-    if (std::dynamic_pointer_cast<Shuttle>(spaceship) == nullptr) throw std::runtime_error(spaceship->getName() + " is not a shuttle and cannot be attacked.");
-    victim = spaceship;
+void Falcon::attack(Spaceship &spaceship) {
+    if (dynamic_cast<Shuttle *>(&spaceship) == nullptr) throw std::runtime_error(spaceship.getName() + " is not a shuttle and cannot be attacked.");
+    victim = spaceship.getHandle();
+    wreck = {};
+    wake();
+}
+void Falcon::attack(const Wreck &remains) {
+    if (remains.getKind() != SHUTTLE) throw std::runtime_error(remains.getSymbol().str() + " is not a shuttle and cannot be attacked.");
+    victim = {};
+    wreck = remains.getSymbol();
+    wake();
 }
 void Falcon::course(double angle, double speed) {
     Spaceship::course(angle);
@@ -316,6 +512,82 @@ void Falcon::go(const Object::Point &point, double speed) {
     Spaceship::go(point);
     setSpeed(speed);
 }
-void Falcon::goTo(const std::shared_ptr<Site> &site) {
-    throw std::runtime_error(getName() + " is a falcon and cannot dock at " + site->getName());
+void Falcon::save(std::ostream &stream) const {
+    Spaceship::save(stream);
+    Spaceship *target = getVictim();
+    const Wreck *remains = getWreck();
+    stream << (target != nullptr ? target->getName() : remains != nullptr ? remains->getSymbol().str() : "-") << ' ';
+}
+void Falcon::restore(std::istream &stream) {
+    Spaceship::restore(stream);
+    std::string name;
+    stream >> name;
+    victim = {};
+    wreck = {};
+    if (name == "-") return;
+    Symbol symbol = Symbol::intern(name);
+    if (getWorld().findWreck(symbol) != nullptr) {
+        wreck = symbol;
+    } else {
+        victim = getWorld().findSpaceship(symbol).getHandle();
+    }
+}
+Spaceship *Falcon::getVictim() const {
+    return getWorld().resolve(victim);
+}
+Wreck *Falcon::getWreck() const {
+    return wreck == Symbol() ? nullptr : getWorld().findWreck(wreck);
 }
+void Falcon::goTo(Site &site) {
+    throw std::runtime_error(getName() + " is a falcon and cannot dock at " + site.getName());
+}
+
+Wreck::Wreck(const Spaceship &spaceship) :
+    name(spaceship.getSymbol()),
+    location(Coordinate::encode(spaceship.getLocation())),
+    agent(spaceship.getAgent() != nullptr ? spaceship.getAgent()->getHandle() : Handle<Agent>()),
+    crystals((uint8_t)spaceship.getCrystals()),
+    kind(spaceship.getKind())
+{
+
+}
+Symbol Wreck::getSymbol() const {
+    return name;
+}
+Spaceship::Kind Wreck::getKind() const {
+    return kind;
+}
+Object::Point Wreck::getLocation() const {
+    return Coordinate::decode(location);
+}
+size_t Wreck::getCrystals() const {
+    return crystals;
+}
+void Wreck::beAttacked(Spaceship &attacker, Model &world) {
+    if (attacker.getLocation().distance(getLocation()) <= 100 && 0 < attacker.getHealth() && !world.isBomberNearby(getLocation())) {
+        attacker.heal();
+        world.recordTheft(attacker.add(crystals));
+        crystals = 0;
+    } else {
+        attacker.hurt();
+    }
+}
+void Wreck::print(std::ostream &stream, const Model &world) const {
+    stream << types[kind] << " " << name << " at position " << Coordinate::decode(location) / 1000 << ". not moving. is dead.";
+    Agent *driver = world.resolve(agent);
+    if (driver != nullptr) {
+        stream << " is driven by " << *driver << ".";
+    }
+    if (kind == Spaceship::SHUTTLE || kind == Spaceship::FALCON) {
+        stream << " holding " << (size_t)crystals << " crystals with 0 health.";
+    }
+}
+
+// Per-ship footprint budgets for the default double coordinates. float coordinates only shrink them.
+// The reference to the owning world costs every ship 8 bytes, and the pointer to a bomber's visited site counts 8 more.
+// benchmark/SpaceshipBenchmark.cpp measures the full footprint, heap included, at 1M ships.
+static_assert(sizeof(Spaceship) <= 120, "Spaceship outgrew its footprint budget");
+static_assert(sizeof(Shuttle) <= 144, "Shuttle outgrew its footprint budget");
+static_assert(sizeof(Bomber) <= 184, "Bomber outgrew its footprint budget");
+static_assert(sizeof(Destroyer) <= 120, "Destroyer outgrew its footprint budget");
+static_assert(sizeof(Falcon) <= 128, "Falcon outgrew its footprint budget");
@@ -0,0 +1,64 @@
+#include "SweepGrid.h"
+#include <algorithm>
+#include <cmath>
+
+SweepGrid::SweepGrid() : cell(1), cells(), oversized(), stamps(), stamp(0) {
+
+}
+
+void SweepGrid::build(const std::vector<Sweep> &targets, double radius, double extent) {
+    cell = std::max({extent, radius, 1.0});
+    cells.clear();
+    oversized.clear();
+    stamps.assign(targets.size(), 0);
+    stamp = 0;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        const Sweep &sweep = targets[i];
+        int64_t minX = cellOf(std::min(sweep.x, sweep.toX) - radius);
+        int64_t maxX = cellOf(std::max(sweep.x, sweep.toX) + radius);
+        int64_t minY = cellOf(std::min(sweep.y, sweep.toY) - radius);
+        int64_t maxY = cellOf(std::max(sweep.y, sweep.toY) + radius);
+        if ((maxX - minX + 1) * (maxY - minY + 1) > maxCells) {
+            oversized.push_back((uint32_t)i);
+            continue;
+        }
+        for (int64_t x = minX; x <= maxX; ++x) {
+            for (int64_t y = minY; y <= maxY; ++y) {
+                cells.emplace_back(key(x, y), (uint32_t)i);
+            }
+        }
+    }
+    std::sort(cells.begin(), cells.end());
+}
+
+void SweepGrid::query(const Sweep &sweep, std::vector<uint32_t> &candidates) const {
+    candidates.clear();
+    if (++stamp == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        stamp = 1;
+    }
+    int64_t minX = cellOf(std::min(sweep.x, sweep.toX));
+    int64_t maxX = cellOf(std::max(sweep.x, sweep.toX));
+    int64_t minY = cellOf(std::min(sweep.y, sweep.toY));
+    int64_t maxY = cellOf(std::max(sweep.y, sweep.toY));
+    for (int64_t x = minX; x <= maxX; ++x) {
+        for (int64_t y = minY; y <= maxY; ++y) {
+            uint64_t k = key(x, y);
+            auto iterator = std::lower_bound(cells.begin(), cells.end(), std::make_pair(k, (uint32_t)0));
+            for (; iterator != cells.end() && iterator->first == k; ++iterator) {
+                if (stamps[iterator->second] == stamp) continue;
+                stamps[iterator->second] = stamp;
+                candidates.push_back(iterator->second);
+            }
+        }
+    }
+    candidates.insert(candidates.end(), oversized.begin(), oversized.end());
+}
+
+int64_t SweepGrid::cellOf(double coordinate) const {
+    return (int64_t)std::floor(coordinate / cell);
+}
+
+uint64_t SweepGrid::key(int64_t x, int64_t y) {
+    return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
@@ -0,0 +1,112 @@
+#include "Symbol.h"
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+    /**
+     * The names live in chunks that never move, chunk k holding firstChunk << k of them, so an id finds its name
+     * with a few bit operations. Worlds on different threads share the table. Interning locks the index, exclusively
+     * only to add a name, and publishes a new chunk with a release store. Reading a name takes no lock: a symbol is
+     * only handed out after its name is written, so whoever holds it can read the name.
+     */
+    struct Table {
+        static constexpr uint32_t firstChunkBits = 10;
+        static constexpr size_t chunks = 33 - firstChunkBits;
+        Table() : mutex(), names(), size(0), ids() {
+            add("");
+        }
+        ~Table() {
+            for (auto &chunk: names) {
+                delete[] chunk.load(std::memory_order_relaxed);
+            }
+        }
+        /**
+         * Get the slot of a name.
+         * @param id The id of the name.
+         * @param create Whether to allocate the chunk of the slot if it is missing. Only with the exclusive lock.
+         * @return The slot.
+         */
+        std::string &slot(uint32_t id, bool create = false) {
+            uint64_t position = (uint64_t)id + (1u << firstChunkBits);
+            int bit = 63 - __builtin_clzll(position);
+            std::atomic<std::string *> &chunk = names[bit - firstChunkBits];
+            std::string *strings = chunk.load(std::memory_order_acquire);
+            if (strings == nullptr && create) {
+                strings = new std::string[(size_t)1 << bit];
+                chunk.store(strings, std::memory_order_release);
+            }
+            return strings[position - ((uint64_t)1 << bit)];
+        }
+        /**
+         * Add a name to the table. Only with the exclusive lock.
+         * @param name The name, not in the table yet.
+         * @return Its id.
+         */
+        uint32_t add(const std::string &name) {
+            uint32_t id = size.load(std::memory_order_relaxed);
+            std::string &stored = slot(id, true);
+            stored = name;
+            ids.emplace(stored, id);
+            size.store(id + 1, std::memory_order_release);
+            return id;
+        }
+        std::shared_mutex mutex;
+        std::atomic<std::string *> names[chunks];
+        std::atomic<uint32_t> size;
+        std::unordered_map<std::string_view, uint32_t> ids;
+    };
+
+    Table &table() {
+        static Table table;
+        return table;
+    }
+}
+
+Symbol::Symbol() : id(0) {
+
+}
+
+Symbol::Symbol(uint32_t id) : id(id) {
+
+}
+
+Symbol Symbol::intern(const std::string &name) {
+    Table &t = table();
+    {
+        std::shared_lock<std::shared_mutex> lock(t.mutex);
+        auto iterator = t.ids.find(name);
+        if (iterator != t.ids.end()) return Symbol(iterator->second);
+    }
+    std::unique_lock<std::shared_mutex> lock(t.mutex);
+    auto iterator = t.ids.find(name);
+    if (iterator != t.ids.end()) return Symbol(iterator->second);
+    return Symbol(t.add(name));
+}
+
+std::optional<Symbol> Symbol::find(const std::string &name) {
+    Table &t = table();
+    std::shared_lock<std::shared_mutex> lock(t.mutex);
+    auto iterator = t.ids.find(name);
+    if (iterator == t.ids.end()) return std::nullopt;
+    return Symbol(iterator->second);
+}
+
+size_t Symbol::count() {
+    return table().size.load(std::memory_order_acquire);
+}
+
+const std::string &Symbol::str() const {
+    return table().slot(id);
+}
+
+uint32_t Symbol::getId() const {
+    return id;
+}
+
+std::ostream &operator<<(std::ostream &stream, const Symbol &symbol) {
+    return stream << symbol.str();
+}
@@ -0,0 +1,73 @@
+#include "TickClock.h"
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+
+TickClock::TickClock(double rate, size_t catchUp) :
+    period(),
+    catchUp(catchUp),
+    last(Clock::now()),
+    accumulated(0),
+    overruns(0),
+    skipped(0),
+    samples(),
+    counts()
+{
+    if (!(rate > 0)) throw std::invalid_argument("The tick rate has to be positive.");
+    if (catchUp == 0) throw std::invalid_argument("At least one tick has to be allowed at once.");
+    period = std::max(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1 / rate)), Clock::duration(1));
+}
+
+size_t TickClock::due() {
+    Clock::time_point now = Clock::now();
+    accumulated += now - last;
+    last = now;
+    auto count = (size_t)(accumulated / period);
+    if (count > catchUp) {
+        skipped += count - catchUp;
+        count = catchUp;
+    }
+    accumulated %= period;
+    return count;
+}
+
+TickClock::Clock::time_point TickClock::next() const {
+    return last + (period - accumulated);
+}
+
+void TickClock::recordTick(Clock::duration duration) {
+    if (duration > period) ++overruns;
+    record(TICKS, duration);
+}
+
+void TickClock::recordLatency(Clock::duration latency) {
+    record(LATENCIES, latency);
+}
+
+void TickClock::record(TickClock::Series series, Clock::duration duration) {
+    std::vector<int64_t> &ring = samples[series];
+    int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    if (ring.size() < window) {
+        ring.push_back(nanoseconds);
+    } else {
+        ring[counts[series] % window] = nanoseconds;
+    }
+    ++counts[series];
+}
+
+void TickClock::print(std::ostream &stream) const {
+    double milliseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(period).count() / 1e6;
+    stream << "Ticking every " << milliseconds << " ms: " << counts[TICKS] << " ticks, " << overruns
+           << " overran their period, " << skipped << " skipped to catch up." << std::endl;
+    static constexpr const char *names[SERIES] = {"Tick", "Command latency"};
+    for (size_t series = 0; series < SERIES; ++series) {
+        if (samples[series].empty()) continue;
+        std::vector<int64_t> sorted = samples[series];
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](size_t percent) -> double {
+            return (double)sorted[(sorted.size() - 1) * percent / 100] / 1e6;
+        };
+        stream << names[series] << ": p50 " << percentile(50) << " ms, p99 " << percentile(99) << " ms, max "
+               << (double)sorted.back() / 1e6 << " ms over the last " << sorted.size() << (series == TICKS ? " ticks." : " commands.") << std::endl;
+    }
+}
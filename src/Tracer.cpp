@@ -0,0 +1,98 @@
+#include "Tracer.h"
+#include <array>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+namespace {
+    /**
+     * The events of one thread. Only the owning thread writes, and it publishes head after the event it wrote.
+     */
+    struct Buffer {
+        std::array<Tracer::Event, Tracer::capacity> events;
+        std::atomic<uint64_t> head{0};
+        size_t thread;
+    };
+
+    /**
+     * Buffers outlive their threads, so a trace written at exit still holds the events of finished threads.
+     */
+    struct Buffers {
+        std::mutex mutex;
+        std::deque<std::unique_ptr<Buffer>> buffers;
+    };
+
+    Buffers &buffers() {
+        static Buffers buffers;
+        return buffers;
+    }
+
+    Buffer &local() {
+        thread_local Buffer *buffer = []() -> Buffer * {
+            Buffers &all = buffers();
+            std::lock_guard<std::mutex> lock(all.mutex);
+            all.buffers.push_back(std::make_unique<Buffer>());
+            all.buffers.back()->thread = all.buffers.size();
+            return all.buffers.back().get();
+        }();
+        return *buffer;
+    }
+
+    void escape(std::ostream &stream, const std::string &string) {
+        static const char *hex = "0123456789abcdef";
+        for (char c: string) {
+            if (c == '"' || c == '\\') {
+                stream << '\\' << c;
+            } else if ((unsigned char)c < 0x20) {
+                stream << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+            } else {
+                stream << c;
+            }
+        }
+    }
+}
+
+void Tracer::setEnabled(bool on) {
+    if constexpr (compiled) enabled.store(on, std::memory_order_relaxed);
+}
+
+void Tracer::record(const Tracer::Event &event) {
+    Buffer &buffer = local();
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[head % capacity] = event;
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+size_t Tracer::dump(std::ostream &stream) {
+    Buffers &all = buffers();
+    std::lock_guard<std::mutex> lock(all.mutex);
+    size_t written = 0;
+    stream << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    for (const auto &buffer: all.buffers) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        for (uint64_t i = head < capacity ? 0 : head - capacity; i < head; ++i) {
+            const Event &event = buffer->events[i % capacity];
+            stream << (written++ == 0 ? "\n" : ",\n") << "{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category
+                   << "\", \"ph\": \"" << event.phase << "\", \"pid\": 1, \"tid\": " << buffer->thread
+                   << ", \"ts\": " << event.start / 1000 << "." << event.start / 100 % 10 << event.start / 10 % 10 << event.start % 10;
+            if (event.phase == 'X') {
+                stream << ", \"dur\": " << event.duration / 1000 << "." << event.duration / 100 % 10 << event.duration / 10 % 10 << event.duration % 10;
+            } else {
+                stream << ", \"s\": \"t\"";
+            }
+            if (event.entity != Symbol()) {
+                stream << ", \"args\": {\"entity\": \"";
+                escape(stream, event.entity.str());
+                if (event.other != Symbol()) {
+                    stream << "\", \"other\": \"";
+                    escape(stream, event.other.str());
+                }
+                stream << "\"}";
+            }
+            stream << "}";
+        }
+    }
+    stream << "\n]}" << std::endl;
+    return written;
+}
@@ -1,4 +1,6 @@
 #include "Utilities.h"
+#include <cstdlib>
+#include <stdexcept>
 
 std::vector<std::string> Utilities::split(const std::string &string, char separator) {
     std::vector<std::string> strings = {""};
@@ -23,4 +25,17 @@ std::string Utilities::getLine(std::istream &stream) {
     std::string line;
     std::getline(stream, line);
     return line;
+}
+void Utilities::writeExact(std::ostream &stream, double value) {
+    std::ios_base::fmtflags flags = stream.flags();
+    stream << std::hexfloat << value << ' ';
+    stream.flags(flags);
+}
+double Utilities::readExact(std::istream &stream) {
+    std::string word;
+    stream >> word;
+    char *end = nullptr;
+    double value = std::strtod(word.c_str(), &end);
+    if (word.empty() || *end != '\0') throw std::invalid_argument("Expected a number instead of " + word + ".");
+    return value;
 }
\ No newline at end of file
@@ -1,5 +1,5 @@
 #include <stdexcept>
-#include <iostream>
+#include <ostream>
 #include <map>
 #include <memory>
 #include <iomanip>
@@ -8,7 +8,7 @@
 #include "Object.h"
 #include "Model.h"
 
-View::View(size_t size, double zoom, double x, double y) : size(size), zoom(zoom), x(x), y(y) {
+View::View(const Model &model, size_t size, double zoom, double x, double y) : model(model), size(size), zoom(zoom), x(x), y(y) {
     this->setOrigin(x, y);
     this->setZoom(zoom);
     this->setSize(size);
@@ -36,24 +36,24 @@ void View::setOrigin(double x0, double y0) {
     makeXAxis();
     makeYAxis();
 }
-void View::show() {
-    std::cout << "Display setSize: " << size << ", scale: " << zoom << ", origin: (" << x / Model::scale << ", " << y / Model::scale << ")" << std::endl;
+void View::show(std::ostream &stream) {
+    stream << "Display setSize: " << size << ", scale: " << zoom << ", origin: (" << x / Model::scale << ", " << y / Model::scale << ")" << std::endl;
     makeMatrix();
-    for (auto &site: Model::get().getSites()) {
+    for (auto &site: model.getSites()) {
         try {
             addToMap(site);
         } catch (const std::out_of_range &exception) {
 
         }
     }
-    for (auto &spaceship: Model::get().getSpaceships()) {
+    for (auto &spaceship: model.getSpaceships()) {
         try {
             addToMap(spaceship);
         } catch (const std::out_of_range &exception) {
 
         }
     }
-    for (auto &rocket: Model::get().getRockets()) {
+    for (auto &rocket: model.getRockets()) {
         try {
             addToMap(rocket);
         } catch (const std::out_of_range &exception) {
@@ -61,19 +61,19 @@ void View::show() {
         }
     }
     for (size_t i = 0; i < size; ++i) {
-        printYAxis(size - i - 1);
+        printYAxis(stream, size - i - 1);
         for (size_t j = 0; j < size; ++j) {
             if (map.find({size - i - 1, j}) == map.end()) {
-                std::cout << space;
+                stream << space;
             } else {
                 std::string toPrint = map.at({size - i - 1, j})->getName().substr(0, strlen(space));
-                std::cout << toPrint;
+                stream << toPrint;
             }
         }
-        std::cout << std::endl;
+        stream << std::endl;
     }
-    printXAxis();
-    std::cout << std::endl;
+    printXAxis(stream);
+    stream << std::endl;
 }
 
 size_t View::getAxisXIndex(double x0) {
@@ -123,28 +123,28 @@ void View::makeMatrix() {
     map = {};
 }
 
-void View::printYAxis(size_t line) {
+void View::printYAxis(std::ostream &stream, size_t line) {
     std::string z = std::to_string((long long) (yAxis[yAxis.size() - 1] / Model::scale));
     std::string z2 = std::to_string((long long) (yAxis[0] / Model::scale));
     size_t maxLength = std::max(z.length(), z2.length());
     if (line % spacing == (size - (size % spacing)) % spacing) {
-        std::cout << std::setw((int)maxLength) << (long long)(yAxis[line] / Model::scale);
-        std::cout << " ";
+        stream << std::setw((int)maxLength) << (long long)(yAxis[line] / Model::scale);
+        stream << " ";
     } else {
         for (size_t i = 0; i <= maxLength; ++i) {
-            std::cout << " ";
+            stream << " ";
         }
     }
 
 }
 
-void View::printXAxis() {
+void View::printXAxis(std::ostream &stream) {
     std::string z = std::to_string((long long) (yAxis[yAxis.size() - 1] / Model::scale));
     std::string z2 = std::to_string((long long) (yAxis[0] / Model::scale));
     size_t maxLength = std::max(z.length(), z2.length());
-    std::cout << "  " << std::setw((int)maxLength) << (long long)(xAxis[0] / Model::scale);
+    stream << "  " << std::setw((int)maxLength) << (long long)(xAxis[0] / Model::scale);
     for (size_t i = spacing; i < size; i += spacing) {
-        std::cout << std::setw((int)(spacing * strlen(space))) << (long long)(xAxis[i] / Model::scale);
+        stream << std::setw((int)(spacing * strlen(space))) << (long long)(xAxis[i] / Model::scale);
     }
 }
 
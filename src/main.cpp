@@ -1,7 +1,34 @@
+#include <cstdlib>
+#include <new>
 #include <sstream>
+#include "Allocations.h"
 #include "Controller.h"
 #include "Spaceship.h"
 
+#ifndef DISABLE_ALLOCATIONS
+/*
+ * Replaced here rather than next to Allocations, so the benchmarks that link the core can count the heap their own way.
+ */
+void *operator new(size_t size) {
+    Allocations::count(size);
+    while (true) {
+        void *pointer = std::malloc(size == 0 ? 1 : size);
+        if (pointer != nullptr) return pointer;
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    std::free(pointer);
+}
+#endif
+
 int main(int argc, char *argv[]) {
     std::cout.precision(2);
     std::cout << std::fixed;
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Controller.h"
+
+/**
+ * Runs many scenarios at once, every one in a world of its own, on a fixed number of threads.
+ * A scenario is the pair of files ScenarioGenerator writes. Its output and errors go to <prefix>.out,
+ * exactly as the game would print them for: game <prefix>.dat < <prefix>.txt
+ * Usage: BatchRunner <threads> <scenario prefix>...
+ */
+
+namespace {
+    struct Scenario {
+        std::string prefix;
+        double seconds;
+        bool loaded;
+    };
+
+    void run(Scenario &scenario) {
+        std::ifstream script(scenario.prefix + ".txt");
+        if (!script) throw std::invalid_argument("Could not open file: " + scenario.prefix + ".txt.");
+        std::ofstream output(scenario.prefix + ".out");
+        if (!output) throw std::invalid_argument("Could not open file: " + scenario.prefix + ".out.");
+        output.precision(2);
+        output << std::fixed;
+        auto begin = std::chrono::steady_clock::now();
+        Controller controller(script, output, output);
+        scenario.loaded = controller.run(scenario.prefix + ".dat");
+        scenario.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t threads;
+    try {
+        if (argc < 3) throw std::invalid_argument("Missing the scenarios.");
+        threads = std::stoull(argv[1]);
+        if (threads == 0) throw std::invalid_argument("There has to be at least one thread.");
+    } catch (const std::exception &exception) {
+        std::cerr << exception.what() << std::endl;
+        std::cerr << "Usage: BatchRunner <threads> <scenario prefix>..." << std::endl;
+        return 1;
+    }
+    std::vector<Scenario> scenarios;
+    for (int i = 2; i < argc; ++i) {
+        scenarios.push_back({argv[i], 0, false});
+    }
+    std::atomic<size_t> next(0);
+    std::vector<std::string> failures(scenarios.size());
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::min(threads, scenarios.size()); ++i) {
+        workers.emplace_back([&scenarios, &next, &failures]() -> void {
+            for (size_t index = next++; index < scenarios.size(); index = next++) {
+                try {
+                    run(scenarios[index]);
+                } catch (const std::exception &exception) {
+                    failures[index] = exception.what();
+                }
+            }
+        });
+    }
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    int status = 0;
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        if (!failures[i].empty()) {
+            std::cerr << scenarios[i].prefix << ": " << failures[i] << std::endl;
+            status = 1;
+        } else if (!scenarios[i].loaded) {
+            std::cerr << scenarios[i].prefix << ": the sites file failed to load, see " << scenarios[i].prefix << ".out." << std::endl;
+            status = 1;
+        } else {
+            std::cout << scenarios[i].prefix << ": " << scenarios[i].seconds << " s" << std::endl;
+        }
+    }
+    std::cout << scenarios.size() << " scenarios on " << std::min(threads, scenarios.size()) << " threads in " << seconds << " s" << std::endl;
+    return status;
+}
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Writes a sites file and a command script that together form a repeatable load test for the game.
+ * The same seed and options always produce the same files, on every platform, since the generator
+ * uses its own random numbers instead of the standard distributions.
+ * Usage: ScenarioGenerator <output prefix> [--option value]...
+ * Run the result with: game <prefix>.dat < <prefix>.txt
+ */
+
+namespace {
+    const std::map<std::string, std::string> defaults = {
+        {"seed", "1"},
+        {"stations", "1000"},
+        {"fortresses", "10"},
+        {"shuttles", "100"},
+        {"bombers", "10"},
+        {"destroyers", "10"},
+        {"falcons", "50"},
+        {"ticks", "100"},
+        {"volley", "10"},
+        {"extent", "1000"},
+        {"distribution", "uniform"},
+        {"clusters", "20"},
+        {"spread", "20"},
+        {"dispatch", "off"},
+        {"stats", "on"},
+    };
+
+    void usage(std::ostream &stream) {
+        stream << "Usage: ScenarioGenerator <output prefix> [--option value]..." << std::endl;
+        stream << "Options and their defaults:" << std::endl;
+        for (const auto &option: defaults) {
+            stream << "  --" << option.first << " " << option.second << std::endl;
+        }
+        stream << "distribution is uniform or clustered. clusters and spread only apply to clustered worlds." << std::endl;
+        stream << "Destroyers shoot at a falcon every volley ticks, 0 never." << std::endl;
+    }
+
+    /**
+     * A 64 bit permuted congruential generator. Its sequence is fully defined here, so scenarios are portable.
+     */
+    class Random {
+    public:
+        explicit Random(uint64_t seed) : state(0) {
+            next();
+            state += seed;
+            next();
+        }
+        uint32_t next() {
+            uint64_t old = state;
+            state = old * 6364136223846793005ULL + 1442695040888963407ULL;
+            auto shifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+            auto rotation = (uint32_t)(old >> 59);
+            return (shifted >> rotation) | (shifted << ((-rotation) & 31));
+        }
+        /**
+         * Get a uniform number.
+         * @return A number in [0, 1).
+         */
+        double uniform() {
+            uint64_t high = next() >> 5;
+            uint64_t low = next() >> 6;
+            return (double)((high << 26) | low) / 9007199254740992.0;
+        }
+        size_t below(size_t bound) {
+            return (size_t)(uniform() * (double)bound);
+        }
+        /**
+         * Get a normally distributed number with the Box-Muller transform.
+         * @return A number with mean 0 and deviation 1.
+         */
+        double normal() {
+            double u = 1 - uniform();
+            double v = uniform();
+            return std::sqrt(-2 * std::log(u)) * std::cos(2 * M_PI * v);
+        }
+    private:
+        uint64_t state;
+    };
+
+    struct Point {
+        double x;
+        double y;
+    };
+
+    /**
+     * Places entities either uniformly over the square [0, extent) or around a fixed set of cluster centers.
+     */
+    class Layout {
+    public:
+        Layout(Random &random, double extent, bool clustered, size_t clusters, double spread) :
+            random(random), extent(extent), spread(spread), centers()
+        {
+            if (!clustered) return;
+            for (size_t i = 0; i < clusters; ++i) {
+                centers.push_back({random.uniform() * extent, random.uniform() * extent});
+            }
+        }
+        Point place() {
+            if (centers.empty()) return {random.uniform() * extent, random.uniform() * extent};
+            const Point &center = centers[random.below(centers.size())];
+            return {clamp(center.x + random.normal() * spread), clamp(center.y + random.normal() * spread)};
+        }
+    private:
+        double clamp(double value) const {
+            return std::min(std::max(value, 0.0), extent);
+        }
+        Random &random;
+        double extent;
+        double spread;
+        std::vector<Point> centers;
+    };
+
+    std::ostream &operator<<(std::ostream &stream, const Point &point) {
+        return stream << "(" << point.x << ", " << point.y << ")";
+    }
+
+    size_t number(const std::map<std::string, std::string> &options, const std::string &name) {
+        try {
+            return std::stoull(options.at(name));
+        } catch (const std::invalid_argument &exception) {
+            throw std::invalid_argument("--" + name + " has to be a non negative integer.");
+        }
+    }
+
+    bool toggle(const std::map<std::string, std::string> &options, const std::string &name) {
+        const std::string &value = options.at(name);
+        if (value != "on" && value != "off") throw std::invalid_argument("--" + name + " has to be on or off.");
+        return value == "on";
+    }
+
+    std::map<std::string, std::string> parse(int argc, char *argv[]) {
+        std::map<std::string, std::string> options = defaults;
+        for (int i = 2; i < argc; i += 2) {
+            std::string option = argv[i];
+            if (option.rfind("--", 0) != 0 || defaults.find(option.substr(2)) == defaults.end()) {
+                throw std::invalid_argument("Unknown option " + option + ".");
+            }
+            if (i + 1 == argc) throw std::invalid_argument(option + " needs a value.");
+            options[option.substr(2)] = argv[i + 1];
+        }
+        const std::string &distribution = options.at("distribution");
+        if (distribution != "uniform" && distribution != "clustered") throw std::invalid_argument("--distribution has to be uniform or clustered.");
+        return options;
+    }
+
+    std::ofstream create(const std::string &path) {
+        std::ofstream file(path);
+        if (!file) throw std::invalid_argument("Could not open file: " + path + ".");
+        file << std::fixed << std::setprecision(2);
+        return file;
+    }
+
+    void generate(const std::string &prefix, const std::map<std::string, std::string> &options) {
+        Random random(number(options, "seed"));
+        Layout layout(random, (double)number(options, "extent"), options.at("distribution") == "clustered",
+                      std::max(number(options, "clusters"), (size_t)1), (double)number(options, "spread"));
+        size_t stations = number(options, "stations");
+        size_t fortresses = number(options, "fortresses");
+        size_t shuttles = number(options, "shuttles");
+        size_t bombers = number(options, "bombers");
+        size_t destroyers = number(options, "destroyers");
+        size_t falcons = number(options, "falcons");
+        size_t ticks = number(options, "ticks");
+        size_t volley = number(options, "volley");
+        if (stations == 0 && (shuttles != 0 || bombers != 0)) throw std::invalid_argument("Shuttles and bombers need at least one station.");
+        std::ofstream sites = create(prefix + ".dat");
+        for (size_t i = 0; i < stations; ++i) {
+            sites << "station, S" << i << ", " << layout.place() << ", " << random.below(1000) << ", " << random.below(10) << "\n";
+        }
+        std::vector<std::string> stars = {"DS"};
+        for (size_t i = 0; i < fortresses; ++i) {
+            sites << "fortress, F" << i << ", " << layout.place() << ", " << random.below(100000) << "\n";
+            stars.push_back("F" + std::to_string(i));
+        }
+        std::ofstream script = create(prefix + ".txt");
+        if (toggle(options, "dispatch")) script << "dispatch on\n";
+        script << "reserve shuttle " << shuttles << "\nreserve bomber " << bombers << "\nreserve destroyer " << destroyers
+               << "\nreserve falcon " << falcons << "\nreserve rocket " << destroyers << "\n";
+        for (size_t i = 0; i < shuttles; ++i) {
+            script << "create midshipman m" << i << "\n";
+            script << "create shuttle h" << i << " m" << i << " " << layout.place() << "\n";
+            script << "h" << i << " start_supply S" << random.below(stations) << " " << stars[random.below(stars.size())] << "\n";
+        }
+        for (size_t i = 0; i < bombers; ++i) {
+            script << "create commander c" << i << "\n";
+            script << "create bomber b" << i << " c" << i << " S" << random.below(stations) << "\n";
+        }
+        for (size_t i = 0; i < destroyers; ++i) {
+            script << "create admiral a" << i << "\n";
+            script << "create destroyer d" << i << " a" << i << " " << layout.place() << "\n";
+        }
+        std::vector<Point> nests;
+        for (size_t i = 0; i < falcons; ++i) {
+            nests.push_back(layout.place());
+            script << "create falcon f" << i << " " << nests.back() << "\n";
+            if (shuttles != 0) script << "f" << i << " attack h" << random.below(shuttles) << "\n";
+        }
+        for (size_t tick = 0; tick < ticks; ++tick) {
+            if (volley != 0 && tick % volley == 0 && !nests.empty()) {
+                for (size_t i = 0; i < destroyers; ++i) {
+                    script << "d" << i << " shoot " << nests[random.below(nests.size())] << "\n";
+                }
+            }
+            script << "go\n";
+        }
+        if (toggle(options, "stats")) script << "economy\nstats\n";
+        script << "exit\n";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    try {
+        if (argc < 2 || std::string(argv[1]).rfind("--", 0) == 0) throw std::invalid_argument("Missing the output prefix.");
+        generate(argv[1], parse(argc, argv));
+    } catch (const std::exception &exception) {
+        std::cerr << exception.what() << std::endl;
+        usage(std::cerr);
+        return 1;
+    }
+    return 0;
+}